@@ -0,0 +1,179 @@
+#pragma once
+
+#include "signal_types.h"
+#include "resampler.h"
+
+#include "wrappers/ipp_alloc.h"
+#include "wrappers/ipp_fft.h"
+#include "wrappers/ipp_linear.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace dsp_utils {
+
+enum class ChannelizerMode {
+    Critical,       // hop == channels, output rate fs / channels
+    Oversampled2x   // hop == channels / 2, output rate 2 fs / channels
+};
+
+
+// Polyphase FFT filter bank (PFB): splits complex input into channels equally spaced
+// subbands, channel k is centered at k / channels cycles per sample (upper half is negative).
+// Every hop input samples the latest prototype.size() samples are weighted by the prototype
+// lowpass, folded into channels points, rotated to keep channel phase continuous and sent
+// through one inverse FFT: cost per input sample is taps_per_channel + log(channels) instead of
+// channels * taps for separate mixer + filter + decimator chains.
+// Prototype has unit DC gain, so a tone at a channel center comes out with its own amplitude.
+// Output of process() is a channels x frames() matrix, row k is time series of channel k
+template<class T>
+class Channelizer
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    // channels must be a power of two
+    Channelizer(size_t channels, ChannelizerMode mode, const std::vector<double>& prototype) :
+        channels_(channels),
+        hop_(mode == ChannelizerMode::Critical ? channels : channels / 2),
+        fft_(ipp::fft_order_ceil(channels))
+    {
+        if (channels < 2 || fft_.size() != channels)
+        {
+            throw std::invalid_argument("Channelizer: channels must be a power of two");
+        }
+
+        branch_size_ = std::max<size_t>((prototype.size() + channels_ - 1) / channels_, 1);
+        length_      = branch_size_ * channels_;
+
+        // reversed: taps line up with history oldest to newest
+        window_ = ipp::allocate_managed<T>(length_);
+        ipp::zero(window_.get(), length_);
+        for (size_t i = 0; i < prototype.size(); ++i)
+            window_[length_ - 1 - i] = static_cast<T>(prototype[i]);
+
+        blocks_      = std::max<size_t>(4, 2 * length_ / hop_);
+        buffer_size_ = length_ - 1 + blocks_ * hop_;
+
+        buffer_  = ipp::allocate_managed<SamplesT>(buffer_size_);
+        work_    = ipp::allocate_managed<SamplesT>(length_);
+        fft_in_  = ipp::allocate_managed<SamplesT>(channels_);
+        fft_out_ = ipp::allocate_managed<SamplesT>(channels_);
+
+        reset();
+    }
+
+    Channelizer(size_t channels, ChannelizerMode mode = ChannelizerMode::Critical,
+                size_t taps_per_channel = 8, double beta = 8.6) :
+        Channelizer(channels, mode, design_lowpass(taps_per_channel * channels, 0.5 / channels, beta))
+    {}
+
+    void reset()
+    {
+        ipp::zero(buffer_.get(), buffer_size_);
+        pos_     = length_ - 1;
+        pending_ = 0;
+        shift_   = (hop_ - 1) % channels_;
+        frames_  = 0;
+    }
+
+    // frames produced by len more samples
+    inline size_t max_frames(size_t len) const { return (pending_ + len) / hop_; }
+
+    // returns number of frames (output samples per channel) produced by this call
+    size_t process(const SamplesT* src, size_t len)
+    {
+        size_t total = max_frames(len);
+        if (total * channels_ > capacity_)
+        {
+            capacity_ = total * channels_;
+            output_   = ipp::allocate_managed<SamplesT>(capacity_);
+        }
+        frames_ = total;
+
+        size_t frame = 0;
+        while (len > 0)
+        {
+            size_t n = std::min(len, hop_ - pending_);
+            ipp::copy(src, buffer_.get() + pos_, n);
+            pos_     += n;
+            pending_ += n;
+            src      += n;
+            len      -= n;
+
+            if (pending_ < hop_)
+                break;
+
+            process_frame(buffer_.get() + pos_ - length_, frame++);
+            pending_ = 0;
+
+            if (pos_ == buffer_size_)
+            {
+                std::copy_n(buffer_.get() + buffer_size_ - (length_ - 1), length_ - 1, buffer_.get());
+                pos_ = length_ - 1;
+            }
+        }
+        return frames_;
+    }
+
+    inline size_t channels() const { return channels_; }
+    inline size_t hop() const { return hop_; }
+    inline size_t taps_per_channel() const { return branch_size_; }
+    // group delay of the prototype, input samples
+    inline double delay() const { return (length_ - 1) / 2.; }
+
+    // results of the last process() call
+    inline size_t frames() const { return frames_; }
+    inline const SamplesT* output() const { return output_.get(); }
+    inline const SamplesT* channel(size_t k) const { return output_.get() + k * frames_; }
+
+private:
+    void process_frame(const SamplesT* history, size_t frame)
+    {
+        SamplesT* w = work_.get();
+        ipp::mul_by_real(window_.get(), history, w, length_);
+        for (size_t b = 1; b < branch_size_; ++b)
+            ipp::add(w + b * channels_, w, channels_);
+
+        // v[r] = q[C - 1 - (r + shift) mod C]: phase reference is absolute sample index
+        SamplesT* v = fft_in_.get();
+        for (size_t r = 0; r < channels_; ++r)
+        {
+            size_t idx = r + shift_;
+            idx -= idx >= channels_ ? channels_ : 0;
+            v[r] = w[channels_ - 1 - idx];
+        }
+        shift_ = (shift_ + hop_) % channels_;
+
+        fft_.backward(fft_in_.get(), fft_out_.get());
+
+        const SamplesT* y = fft_out_.get();
+        SamplesT* dst     = output_.get() + frame;
+        for (size_t k = 0; k < channels_; ++k)
+            dst[k * frames_] = y[k];
+    }
+
+    size_t channels_;
+    size_t hop_;
+    size_t branch_size_ = 0;
+    size_t length_      = 0;
+    size_t blocks_      = 0;
+    size_t buffer_size_ = 0;
+
+    size_t pos_      = 0;
+    size_t pending_  = 0;
+    size_t shift_    = 0;
+    size_t frames_   = 0;
+    size_t capacity_ = 0;
+
+    ipp::FFT<T> fft_;
+
+    ipp::managed_sequence_ptr<T> window_          = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> buffer_   = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> work_     = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> fft_in_   = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> fft_out_  = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> output_   = nullptr;
+};
+
+}
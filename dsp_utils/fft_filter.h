@@ -0,0 +1,116 @@
+#pragma once
+
+#include "signal_types.h"
+
+#include "wrappers/ipp_alloc.h"
+#include "wrappers/ipp_fft.h"
+#include "wrappers/ipp_linear.h"
+
+#include <algorithm>
+
+namespace dsp_utils {
+
+// Streaming FIR filter, overlap-save on blocks of FFT size N.
+// Every block consumes L = N - taps + 1 new samples.
+// process() writes as many samples as it reads, output is delayed by latency() == L samples
+// (on top of filter own delay). No allocations after construction.
+template<class T>
+class FftFilter
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    // order == 0: smallest FFT with N >= 2 * taps_count
+    FftFilter(const SamplesT* taps, size_t taps_count, size_t order = 0) :
+        taps_count_(std::max<size_t>(taps_count, 1)),
+        fft_(std::max(order, ipp::fft_order_ceil(2 * taps_count_)), ipp::NORM_BACKWARD)
+    {
+        size_t N = fft_.size();
+        step_    = N - taps_count_ + 1;
+
+        spectrum_ = ipp::allocate_managed<SamplesT>(N);
+        block_    = ipp::allocate_managed<SamplesT>(N);
+        work_     = ipp::allocate_managed<SamplesT>(N);
+        ready_    = ipp::allocate_managed<SamplesT>(step_);
+
+        ipp::zero(spectrum_.get(), N);
+        ipp::copy(taps, spectrum_.get(), taps_count);
+        fft_.forward(spectrum_.get());
+
+        reset();
+    }
+
+    FftFilter(const std::vector<SamplesT>& taps, size_t order = 0) :
+        FftFilter(taps.data(), taps.size(), order)
+    {}
+
+    void reset()
+    {
+        ipp::zero(block_.get(), fft_.size());
+        ipp::zero(ready_.get(), step_);
+        pos_ = 0;
+    }
+
+    // src and dst may be the same buffer
+    void process(const SamplesT* src, SamplesT* dst, size_t len)
+    {
+        SamplesT* history_end = block_.get() + taps_count_ - 1;
+
+        while (len > 0)
+        {
+            size_t n = std::min(len, step_ - pos_);
+
+            ipp::copy(src, history_end + pos_, n);
+            ipp::copy(ready_.get() + pos_, dst, n);
+
+            pos_ += n;
+            src  += n;
+            dst  += n;
+            len  -= n;
+
+            if (pos_ == step_)
+            {
+                filter_block();
+                pos_ = 0;
+            }
+        }
+    }
+
+    void process(SamplesT* srcDst, size_t len)
+    {
+        process(srcDst, srcDst, len);
+    }
+
+    inline size_t latency() const { return step_; }
+    inline size_t block_size() const { return step_; }
+    inline size_t fft_size() const { return fft_.size(); }
+    inline size_t taps_count() const { return taps_count_; }
+
+private:
+
+    void filter_block()
+    {
+        fft_.forward(block_.get(), work_.get());
+        ipp::mul(spectrum_.get(), work_.get(), fft_.size());
+        fft_.backward(work_.get());
+
+        // first taps - 1 outputs are wrapped around -- dropped
+        ipp::copy(work_.get() + taps_count_ - 1, ready_.get(), step_);
+
+        // tail of the block becomes history for the next one
+        ipp::copy(block_.get() + step_, block_.get(), taps_count_ - 1);
+    }
+
+    size_t taps_count_;
+    size_t step_;
+    size_t pos_ = 0;
+
+    ipp::FFT<T> fft_;
+
+    ipp::managed_sequence_ptr<SamplesT> spectrum_ = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> block_    = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> work_     = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> ready_    = nullptr;
+};
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "signal_types.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace dsp_utils {
+
+// Histogram with fixed bounds [lo, hi], lo < hi, and equal bins.
+// Samples outside the bounds (and NaNs) are counted in underflow()/overflow(),
+// hi itself falls into the last bin.
+// Histograms with equal bounds can be merged, so chunks or threads can be
+// binned independently
+template <class T>
+class Histogram {
+public:
+    static_assert (is_real_v<T>, "only real signals supported!");
+
+    Histogram(T lo, T hi, size_t bins):
+        lo_(lo), hi_(hi),
+        bins_(std::max<size_t>(bins, 1)),
+        scale_(bins_ / (static_cast<double>(hi) - lo)),
+        counts_(bins_ + 2, 0)
+    {
+        if (!(lo < hi)){
+            throw std::invalid_argument("histogram bounds must satisfy lo < hi");
+        }
+    }
+
+    void add(const T* src, size_t len){
+        uint64_t* counts = counts_.data();
+        const double lo = lo_;
+        const double hi = hi_;
+        const double scale = scale_;
+        const size_t last = bins_;
+
+        for (size_t i = 0; i < len; ++i){
+            double x = src[i];
+            double pos = (x - lo) * scale;
+            size_t idx = !(pos >= 0) ? 0
+                       : (x <= hi ? std::min(static_cast<size_t>(pos), last - 1) + 1 : last + 1);
+            counts[idx]++;
+        }
+    }
+
+    void add(const std::vector<T>& chunk){
+        add(chunk.data(), chunk.size());
+    }
+
+    void merge(const Histogram& other){
+        if (other.lo_ != lo_ || other.hi_ != hi_ || other.bins_ != bins_){
+            throw std::invalid_argument("histograms bounds mismatch");
+        }
+        for (size_t i = 0; i < counts_.size(); ++i)
+            counts_[i] += other.counts_[i];
+    }
+
+    void clear(){
+        std::fill(begin(counts_), end(counts_), 0);
+    }
+
+    inline const uint64_t* counts() const { return counts_.data() + 1; }
+    inline uint64_t count(size_t bin) const { return counts_.at(bin + 1); }
+    inline uint64_t underflow() const { return counts_.front(); }
+    inline uint64_t overflow() const { return counts_.back(); }
+
+    // samples inside bounds
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (size_t i = 1; i <= bins_; ++i)
+            sum += counts_[i];
+        return sum;
+    }
+
+    inline size_t bins() const { return bins_; }
+    inline T lo() const { return lo_; }
+    inline T hi() const { return hi_; }
+    inline double bin_width() const { return (static_cast<double>(hi_) - lo_) / bins_; }
+    inline double bin_center(size_t bin) const { return lo_ + (bin + 0.5) * bin_width(); }
+
+private:
+    T lo_;
+    T hi_;
+    size_t bins_;
+    double scale_;
+    std::vector<uint64_t> counts_; // [underflow, bins..., overflow]
+};
+
+
+// every worker fills own partial histogram, partials are merged at the end
+template <class T>
+Histogram<T> histogram_parallel(const T* src, size_t len, T lo, T hi, size_t bins,
+                                ThreadPool& pool = ThreadPool::global(), size_t grain = 1 << 16)
+{
+    std::vector<Histogram<T>> partial(pool.size(), Histogram<T>(lo, hi, bins));
+
+    parallel_for(pool, len, grain, [&](size_t begin, size_t end, size_t worker){
+        partial[worker].add(src + begin, end - begin);
+    });
+
+    for (size_t i = 1; i < partial.size(); ++i)
+        partial.front().merge(partial[i]);
+
+    return partial.front();
+}
+
+template <class T>
+Histogram<T> histogram_parallel(const std::vector<T>& sig, T lo, T hi, size_t bins,
+                                ThreadPool& pool = ThreadPool::global(), size_t grain = 1 << 16)
+{
+    return histogram_parallel(sig.data(), sig.size(), lo, hi, bins, pool, grain);
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "signal_types.h"
+#include "window.h"
+
+#include "wrappers/ipp_alloc.h"
+#include "wrappers/ipp_fft.h"
+#include "wrappers/ipp_linear.h"
+#include "wrappers/ipp_transforms.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace dsp_utils {
+
+// Pulse compression against fixed reference (e.g. signal_gen::lfm):
+// dst[n] = sum_k pulse[n + k] * conj(ref[k] * w[k]), n in [0, pulse length).
+// Reference spectrum, FFT plan and scratch are kept between calls -- no allocations in compress()
+template<class T>
+class MatchedFilter
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    // weighted: reference is multiplied by window::taylor(reference size, SSL)
+    MatchedFilter(const SamplesT* reference, size_t reference_size, size_t max_pulse_size,
+                  bool weighted = false, double SSL = -35) :
+        reference_size_(reference_size),
+        max_pulse_size_(max_pulse_size),
+        fft_(ipp::fft_order_ceil(max_pulse_size + reference_size - 1), ipp::NORM_BACKWARD)
+    {
+        spectrum_ = ipp::allocate_managed<SamplesT>(fft_.size());
+        work_     = ipp::allocate_managed<SamplesT>(fft_.size());
+
+        ipp::zero(spectrum_.get(), fft_.size());
+        ipp::copy(reference, spectrum_.get(), reference_size_);
+
+        if (weighted)
+        {
+            auto w = window::cached<T>(window::Type::Taylor, reference_size_, SSL);
+            window::apply(w, spectrum_.get());
+        }
+
+        fft_.forward(spectrum_.get());
+        ipp::conj(spectrum_.get(), fft_.size());
+    }
+
+    MatchedFilter(const std::vector<SamplesT>& reference, size_t max_pulse_size,
+                  bool weighted = false, double SSL = -35) :
+        MatchedFilter(reference.data(), reference.size(), max_pulse_size, weighted, SSL)
+    {}
+
+    // dst holds len samples, dst may be equal to pulse
+    void compress(const SamplesT* pulse, size_t len, SamplesT* dst)
+    {
+        if (len > max_pulse_size_)
+        {
+            throw std::range_error("pulse is longer than max_pulse_size");
+        }
+
+        ipp::copy(pulse, work_.get(), len);
+        ipp::zero(work_.get() + len, fft_.size() - len);
+
+        fft_.forward(work_.get());
+        ipp::mul(spectrum_.get(), work_.get(), fft_.size());
+        fft_.backward(work_.get());
+
+        ipp::copy(work_.get(), dst, len);
+    }
+
+    // count pulses of len samples, pulse i at pulses + i * stride
+    void compress(const SamplesT* pulses, size_t len, size_t stride, size_t count,
+                  SamplesT* dst, size_t dst_stride)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            compress(pulses + i * stride, len, dst + i * dst_stride);
+        }
+    }
+
+    inline size_t reference_size() const { return reference_size_; }
+    inline size_t max_pulse_size() const { return max_pulse_size_; }
+    inline size_t fft_size() const { return fft_.size(); }
+
+private:
+    size_t reference_size_;
+    size_t max_pulse_size_;
+
+    ipp::FFT<T> fft_;
+
+    ipp::managed_sequence_ptr<SamplesT> spectrum_ = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> work_     = nullptr;
+};
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "signal_types.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace dsp_utils {
+
+// Streaming sliding-window quantile (median by default) filter.
+// Window values are split into two ordered multisets: lower part holds ranks [0, k],
+// upper part -- the rest, so the answer is the largest element of lower part.
+// Insert / remove / rebalance are O(log window) per sample.
+// First window - 1 outputs are computed over the samples seen so far
+template <class T>
+class MedianFilter {
+public:
+    static_assert (is_real_v<T>, "only real signals supported!");
+
+    MedianFilter(size_t window, double q = 0.5):
+        window_(std::max<size_t>(window, 1)),
+        q_(std::min(std::max(q, 0.), 1.)),
+        ring_(window_)
+    {}
+
+    void reset(){
+        lower_.clear();
+        upper_.clear();
+        count_ = 0;
+        pos_ = 0;
+    }
+
+    T push(T x){
+        if (count_ == window_){
+            remove(ring_[pos_]);
+        } else {
+            ++count_;
+        }
+        ring_[pos_] = x;
+        pos_ = (pos_ + 1) % window_;
+
+        insert(x);
+        rebalance();
+
+        return *lower_.rbegin();
+    }
+
+    // dst may be equal to src
+    void process(const T* src, T* dst, size_t len){
+        for (size_t i = 0; i < len; ++i)
+            dst[i] = push(src[i]);
+    }
+
+    void process(T* srcDst, size_t len){
+        process(srcDst, srcDst, len);
+    }
+
+    inline size_t window() const { return window_; }
+    inline double q() const { return q_; }
+
+private:
+
+    // same rank as quantile() in transforms.h
+    size_t target_lower_size() const {
+        return std::min(static_cast<size_t>(q_ * count_), count_ - 1) + 1;
+    }
+
+    // keeps every element of lower part <= every element of upper part
+    void insert(T x){
+        if (!upper_.empty() && x > *upper_.begin())
+            upper_.insert(x);
+        else
+            lower_.insert(x);
+    }
+
+    void remove(T x){
+        if (!lower_.empty() && x <= *lower_.rbegin())
+            lower_.erase(lower_.find(x));
+        else
+            upper_.erase(upper_.find(x));
+    }
+
+    void rebalance(){
+        size_t target = target_lower_size();
+        while (lower_.size() > target){
+            auto it = std::prev(lower_.end());
+            upper_.insert(*it);
+            lower_.erase(it);
+        }
+        while (lower_.size() < target){
+            auto it = upper_.begin();
+            lower_.insert(*it);
+            upper_.erase(it);
+        }
+    }
+
+    size_t window_;
+    double q_;
+
+    std::vector<T> ring_;
+    size_t count_ = 0;
+    size_t pos_ = 0;
+
+    std::multiset<T> lower_;
+    std::multiset<T> upper_;
+};
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "signal_types.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace dsp_utils {
+
+namespace moments_detail {
+
+template <class T>
+inline double load(const T& x, std::enable_if_t<is_real_v<T>>* = nullptr) { return static_cast<double>(x); }
+
+template <class T>
+inline std::complex<double> load(const std::complex<T>& x) { return {x.real(), x.imag()}; }
+
+inline std::complex<double> load(const Ipp32fc& x) { return {x.re, x.im}; }
+inline std::complex<double> load(const Ipp64fc& x) { return {x.re, x.im}; }
+
+inline double sqr_abs(double x) { return x * x; }
+// not std::norm: libstdc++ computes it through std::abs (hypot) unless -ffast-math
+inline double sqr_abs(const std::complex<double>& x) { return x.real() * x.real() + x.imag() * x.imag(); }
+
+template <class T>
+inline T store(double x, std::enable_if_t<is_real_v<T>>* = nullptr) { return static_cast<T>(x); }
+
+template <class T>
+inline T store(const std::complex<double>& x, std::enable_if_t<!std::is_same<T, Ipp32fc>::value &&
+                                                                 !std::is_same<T, Ipp64fc>::value>* = nullptr)
+{
+    return T(x.real(), x.imag());
+}
+
+template <class T>
+inline T store(const std::complex<double>& x, std::enable_if_t<std::is_same<T, Ipp32fc>::value ||
+                                                                std::is_same<T, Ipp64fc>::value>* = nullptr)
+{
+    return T{static_cast<decltype(T::re)>(x.real()), static_cast<decltype(T::re)>(x.imag())};
+}
+
+}
+
+
+// count, mean, sum of squared deviations and range of a sequence.
+// Partial results of chunks / threads are combined with merge() (Chan et al.).
+// For complex samples min/max are taken over magnitudes
+template <class T>
+struct Moments {
+    using mean_type = std::conditional_t<is_complex_v<T>, std::complex<double>, double>;
+
+    uint64_t count = 0;
+    mean_type mean = mean_type(0);
+    double m2 = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    inline double variance() const { return count ? m2 / count : 0; }
+    inline double sample_variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+    inline double stddev() const { return std::sqrt(variance()); }
+    inline double max_abs() const { return is_complex_v<T> ? max : std::max(std::abs(min), std::abs(max)); }
+
+    void merge(const Moments& other){
+        if (other.count == 0)
+            return;
+        if (count == 0){
+            *this = other;
+            return;
+        }
+        double n = static_cast<double>(count + other.count);
+        mean_type delta = other.mean - mean;
+
+        mean += delta * (other.count / n);
+        m2 += other.m2 + moments_detail::sqr_abs(delta) * (static_cast<double>(count) * other.count / n);
+        count += other.count;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+};
+
+
+// block small enough to stay in L1: sum & range in one loop,
+// squared deviations from block mean in the second one.
+// Complex range is tracked on squared magnitudes, sqrt is taken once per block
+template <class T>
+Moments<T> moments(const T* src, size_t len, size_t block = 1024)
+{
+    using mean_type = typename Moments<T>::mean_type;
+    block = std::max<size_t>(block, 1);
+
+    Moments<T> total;
+    for (size_t start = 0; start < len; start += block){
+        const T* x = src + start;
+        size_t n = std::min(block, len - start);
+
+        Moments<T> b;
+        mean_type sum = mean_type(0);
+        for (size_t i = 0; i < n; ++i){
+            auto v = moments_detail::load(x[i]);
+            sum += v;
+            double r;
+            if constexpr (is_complex_v<T>)
+                r = moments_detail::sqr_abs(v);
+            else
+                r = v;
+            b.min = std::min(b.min, r);
+            b.max = std::max(b.max, r);
+        }
+        if constexpr (is_complex_v<T>){
+            b.min = std::sqrt(b.min);
+            b.max = std::sqrt(b.max);
+        }
+
+        b.count = n;
+        b.mean = sum / static_cast<double>(n);
+
+        double m2 = 0;
+        for (size_t i = 0; i < n; ++i)
+            m2 += moments_detail::sqr_abs(moments_detail::load(x[i]) - b.mean);
+        b.m2 = m2;
+
+        total.merge(b);
+    }
+    return total;
+}
+
+template <class T, class Alloc>
+Moments<T> moments(const std::vector<T, Alloc>& sig)
+{
+    return moments(sig.data(), sig.size());
+}
+
+
+// every worker reduces own ranges, partials are merged at the end
+template <class T>
+Moments<T> moments_parallel(const T* src, size_t len,
+                            ThreadPool& pool = ThreadPool::global(), size_t grain = 1 << 16)
+{
+    std::vector<Moments<T>> partial(pool.size());
+
+    parallel_for(pool, len, grain, [&](size_t begin, size_t end, size_t worker){
+        partial[worker].merge(moments(src + begin, end - begin));
+    });
+
+    for (size_t i = 1; i < partial.size(); ++i)
+        partial.front().merge(partial[i]);
+
+    return partial.front();
+}
+
+template <class T, class Alloc>
+Moments<T> moments_parallel(const std::vector<T, Alloc>& sig,
+                            ThreadPool& pool = ThreadPool::global(), size_t grain = 1 << 16)
+{
+    return moments_parallel(sig.data(), sig.size(), pool, grain);
+}
+
+}
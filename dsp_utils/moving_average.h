@@ -0,0 +1,216 @@
+#pragma once
+
+#include "signal_types.h"
+
+#include "wrappers/ipp_linear.h"
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace dsp_utils {
+
+// accumulator used by MovingSum: wider than samples to keep long runs exact enough
+template <class T, class Enable = void>
+struct MovingSumTraits {
+    using acc_type = T;
+    static acc_type load(const T& x) { return x; }
+    static T store(const acc_type& acc, double scale) { return static_cast<T>(acc * scale); }
+};
+
+template <class T>
+struct MovingSumTraits<T, std::enable_if_t<std::is_floating_point<T>::value>> {
+    using acc_type = double;
+    static acc_type load(const T& x) { return x; }
+    static T store(const acc_type& acc, double scale) { return static_cast<T>(acc * scale); }
+};
+
+template <class T>
+struct MovingSumTraits<std::complex<T>> {
+    using acc_type = std::complex<double>;
+    static acc_type load(const std::complex<T>& x) { return {x.real(), x.imag()}; }
+    static std::complex<T> store(const acc_type& acc, double scale) {
+        return {static_cast<T>(acc.real() * scale), static_cast<T>(acc.imag() * scale)};
+    }
+};
+
+template <>
+struct MovingSumTraits<Ipp32fc> {
+    using acc_type = std::complex<double>;
+    static acc_type load(const Ipp32fc& x) { return {x.re, x.im}; }
+    static Ipp32fc store(const acc_type& acc, double scale) {
+        return {static_cast<Ipp32f>(acc.real() * scale), static_cast<Ipp32f>(acc.imag() * scale)};
+    }
+};
+
+template <>
+struct MovingSumTraits<Ipp64fc> {
+    using acc_type = std::complex<double>;
+    static acc_type load(const Ipp64fc& x) { return {x.re, x.im}; }
+    static Ipp64fc store(const acc_type& acc, double scale) {
+        return {acc.real() * scale, acc.imag() * scale};
+    }
+};
+
+
+
+// src[i] - src[i - window] for one block: generic types in accumulator precision
+template <class T, class Enable = void>
+struct MovingDiff {
+    using Traits    = MovingSumTraits<T>;
+    using diff_type = typename Traits::acc_type;
+
+    static diff_type load(const diff_type& d) { return d; }
+
+    // dst = cur - old
+    static void sub(const T* old, const T* cur, diff_type* dst, size_t n){
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = Traits::load(cur[i]) - Traits::load(old[i]);
+    }
+};
+
+// IPP float types: ippsSub straight from input, differences rounded once to sample precision
+template <class T>
+struct IppMovingDiff {
+    using diff_type = T;
+
+    static typename MovingSumTraits<T>::acc_type load(const T& d) { return MovingSumTraits<T>::load(d); }
+
+    static void sub(const T* old, const T* cur, T* dst, size_t n){
+        ipp::sub(old, cur, dst, n);
+    }
+};
+
+template <> struct MovingDiff<Ipp32f> : IppMovingDiff<Ipp32f> {};
+template <> struct MovingDiff<Ipp64f> : IppMovingDiff<Ipp64f> {};
+template <> struct MovingDiff<Ipp32fc> : IppMovingDiff<Ipp32fc> {};
+template <> struct MovingDiff<Ipp64fc> : IppMovingDiff<Ipp64fc> {};
+
+
+// Streaming moving sum: dst[n] = scale * (src[n] + ... + src[n - window + 1]).
+// Samples before the first one are zeros. State is kept between process() calls.
+// Input is handled in blocks: differences src[n] - src[n - window] are taken straight from input
+// (ippsSub for IPP float types) with only the last window samples kept as history, then
+// prefix-summed in tiles of 4 samples added to the running sum.
+// Every reanchor_period samples the sum is recomputed from the window to drop accumulated error
+template <class T>
+class MovingSum {
+public:
+    using Traits    = MovingSumTraits<T>;
+    using Diff      = MovingDiff<T>;
+    using acc_type  = typename Traits::acc_type;
+    using diff_type = typename Diff::diff_type;
+
+    MovingSum(size_t window, double scale = 1, size_t reanchor_period = 1 << 20, size_t block = 4096):
+        window_(std::max<size_t>(window, 1)),
+        block_(std::max(block, window_)),
+        reanchor_period_(std::max(reanchor_period, window_)),
+        scale_(scale),
+        history_(window_, T{}),
+        diff_(block_)
+    {}
+
+    void reset(){
+        std::fill(begin(history_), end(history_), T{});
+        sum_ = acc_type(0);
+        since_anchor_ = 0;
+    }
+
+    // dst may be equal to src
+    void process(const T* src, T* dst, size_t len){
+        while (len > 0){
+            size_t n = std::min(len, block_);
+            process_block(src, dst, n);
+            src += n;
+            dst += n;
+            len -= n;
+        }
+    }
+
+    void process(T* srcDst, size_t len){
+        process(srcDst, srcDst, len);
+    }
+
+    inline size_t window() const { return window_; }
+    inline double scale() const { return scale_; }
+
+private:
+
+    void process_block(const T* src, T* dst, size_t n){
+        const size_t w = window_;
+
+        // history_[i] is sample i - w relative to block start
+        Diff::sub(history_.data(), src, diff_.data(), std::min(n, w));
+        if (n > w)
+            Diff::sub(src, src + w, diff_.data() + w, n - w);
+
+        // history is updated before dst (possibly == src) is written
+        if (n >= w){
+            std::copy(src + n - w, src + n, history_.begin());
+        } else {
+            std::copy(history_.begin() + n, history_.end(), history_.begin());
+            std::copy(src, src + n, history_.end() - n);
+        }
+
+        prefix_sum(dst, n);
+
+        since_anchor_ += n;
+        if (since_anchor_ >= reanchor_period_){
+            reanchor();
+        }
+    }
+
+    // tiles of 4 samples: the in-tile prefix does not depend on the running sum, so tiles
+    // overlap and the loop-carried chain is one add per tile instead of one per sample
+    void prefix_sum(T* dst, size_t n){
+        const diff_type* d = diff_.data();
+        acc_type sum = sum_;
+
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4){
+            acc_type p0 = Diff::load(d[i]);
+            acc_type p1 = p0 + Diff::load(d[i + 1]);
+            acc_type p2 = p1 + Diff::load(d[i + 2]);
+            acc_type p3 = p2 + Diff::load(d[i + 3]);
+            dst[i]     = Traits::store(sum + p0, scale_);
+            dst[i + 1] = Traits::store(sum + p1, scale_);
+            dst[i + 2] = Traits::store(sum + p2, scale_);
+            dst[i + 3] = Traits::store(sum + p3, scale_);
+            sum += p3;
+        }
+        for (; i < n; ++i){
+            sum += Diff::load(d[i]);
+            dst[i] = Traits::store(sum, scale_);
+        }
+        sum_ = sum;
+    }
+
+    void reanchor(){
+        acc_type sum = acc_type(0);
+        for (size_t i = 0; i < window_; ++i)
+            sum += Traits::load(history_[i]);
+        sum_ = sum;
+        since_anchor_ = 0;
+    }
+
+    size_t window_;
+    size_t block_;
+    size_t reanchor_period_;
+    double scale_;
+
+    std::vector<T> history_;
+    std::vector<diff_type> diff_;
+    acc_type sum_ = acc_type(0);
+    size_t since_anchor_ = 0;
+};
+
+
+template <class T>
+class MovingAverage : public MovingSum<T> {
+public:
+    MovingAverage(size_t window, size_t reanchor_period = 1 << 20, size_t block = 4096):
+        MovingSum<T>(window, 1. / std::max<size_t>(window, 1), reanchor_period, block)
+    {}
+};
+
+}
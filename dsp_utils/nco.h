@@ -0,0 +1,152 @@
+#pragma once
+
+#include "signal_types.h"
+
+#include "wrappers/ipp_types.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace dsp_utils {
+
+// Numerically controlled oscillator / digital mixer.
+// Phase, frequency and frequency ramp persist between calls, so a stream can be shifted
+// chunk by chunk without discontinuities. Tone is not materialized: it is produced by
+// second-order phase recurrence in lanes independent accumulators and multiplied into
+// the samples in the same loop. Phase is recomputed in double every resync samples.
+// Frequency is normalized (cycles per sample), ramp is in cycles per sample^2
+template<class T>
+class Nco
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    static constexpr size_t lanes  = 8;
+    static constexpr size_t resync = 1024;
+
+    explicit Nco(double frequency = 0, double phase = 0, double ramp = 0) :
+        frequency_(frequency),
+        ramp_(ramp)
+    {
+        set_phase(phase);
+    }
+
+    inline double frequency() const { return frequency_; }
+    inline void set_frequency(double frequency) { frequency_ = frequency; }
+
+    inline double ramp() const { return ramp_; }
+    inline void set_ramp(double ramp) { ramp_ = ramp; }
+
+    // radians, [0, 2 pi)
+    inline double phase() const { return phase_; }
+    inline void set_phase(double phase)
+    {
+        phase_ = std::fmod(phase, 2 * M_PI);
+        if (phase_ < 0)
+            phase_ += 2 * M_PI;
+    }
+
+    // srcDst[n] *= e^(i * phase[n])
+    void mix(SamplesT* srcDst, size_t len)
+    {
+        process<true>(srcDst, srcDst, len);
+    }
+
+    void mix(const SamplesT* src, SamplesT* dst, size_t len)
+    {
+        process<true>(src, dst, len);
+    }
+
+    // dst[n] = e^(i * phase[n])
+    void generate(SamplesT* dst, size_t len)
+    {
+        process<false>(nullptr, dst, len);
+    }
+
+private:
+    template<bool Mix>
+    void process(const SamplesT* src, SamplesT* dst, size_t len)
+    {
+        while (len > 0)
+        {
+            size_t n = std::min(len, resync);
+            start_block();
+
+            for (size_t m = 0; m < n; m += lanes)
+                step<Mix>(Mix ? src + m : src, dst + m, std::min(lanes, n - m));
+
+            advance(n);
+            if (Mix)
+                src += n;
+            dst += n;
+            len -= n;
+        }
+    }
+
+    // lanes state for phase(m) = phase_ + b m + a m^2
+    void start_block()
+    {
+        const double b = 2 * M_PI * frequency_;
+        const double a = M_PI * ramp_;
+        const double L = lanes;
+
+        for (size_t i = 0; i < lanes; ++i)
+        {
+            double m  = i;
+            double ph = phase_ + b * m + a * m * m;
+            double d  = b * L + a * (2 * m * L + L * L);
+            zr_[i] = std::cos(ph);
+            zi_[i] = std::sin(ph);
+            ur_[i] = std::cos(d);
+            ui_[i] = std::sin(d);
+        }
+        rr_ = std::cos(2 * a * L * L);
+        ri_ = std::sin(2 * a * L * L);
+    }
+
+    template<bool Mix>
+    void step(const SamplesT* src, SamplesT* dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (Mix)
+            {
+                double xr = src[i].re, xi = src[i].im;
+                dst[i].re = static_cast<T>(xr * zr_[i] - xi * zi_[i]);
+                dst[i].im = static_cast<T>(xr * zi_[i] + xi * zr_[i]);
+            }
+            else
+            {
+                dst[i].re = static_cast<T>(zr_[i]);
+                dst[i].im = static_cast<T>(zi_[i]);
+            }
+        }
+
+        for (size_t i = 0; i < lanes; ++i)
+        {
+            double zr = zr_[i] * ur_[i] - zi_[i] * ui_[i];
+            double zi = zr_[i] * ui_[i] + zi_[i] * ur_[i];
+            double ur = ur_[i] * rr_ - ui_[i] * ri_;
+            double ui = ur_[i] * ri_ + ui_[i] * rr_;
+            zr_[i] = zr; zi_[i] = zi;
+            ur_[i] = ur; ui_[i] = ui;
+        }
+    }
+
+    // exact phase / frequency after n samples
+    void advance(size_t n)
+    {
+        double dn = n;
+        set_phase(phase_ + 2 * M_PI * (frequency_ * dn + 0.5 * ramp_ * dn * dn));
+        frequency_ += ramp_ * dn;
+    }
+
+    double frequency_;
+    double ramp_;
+    double phase_ = 0;
+
+    double zr_[lanes], zi_[lanes], ur_[lanes], ui_[lanes];
+    double rr_ = 1, ri_ = 0;
+};
+
+}
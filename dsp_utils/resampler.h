@@ -0,0 +1,397 @@
+#pragma once
+
+#include "signal_types.h"
+#include "window.h"
+
+#include "wrappers/ipp_types.h"
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+namespace dsp_utils {
+
+// Windowed-sinc (Kaiser) lowpass, cutoff in cycles per sample (0, 0.5), unit DC gain
+inline std::vector<double> design_lowpass(size_t taps_count, double cutoff, double beta = 8.6)
+{
+    taps_count = std::max<size_t>(taps_count, 1);
+
+    // symmetric window of taps_count points is periodic one of taps_count - 1 plus the first tap
+    std::vector<double> w = window::kaiser<double>(std::max<size_t>(taps_count - 1, 1), beta);
+    w.resize(taps_count, w.front());
+
+    std::vector<double> h(taps_count);
+    double center = (taps_count - 1) / 2.;
+    double sum    = 0;
+    for (size_t i = 0; i < taps_count; ++i)
+    {
+        double t = i - center;
+        double s = t == 0 ? 2 * cutoff : std::sin(2 * M_PI * cutoff * t) / (M_PI * t);
+        h[i] = s * w[i];
+        sum += h[i];
+    }
+    for (auto& v : h)
+        v /= sum;
+    return h;
+}
+
+// taps_count = 4k + 3: every other tap (except center) is zero
+inline std::vector<double> design_halfband(size_t taps_count = 31, double beta = 8.6)
+{
+    taps_count = (std::max<size_t>(taps_count, 3) - 3) / 4 * 4 + 3;
+    auto h = design_lowpass(taps_count, 0.25, beta);
+    size_t center = taps_count / 2;
+    for (size_t i = 0; i < taps_count; ++i)
+    {
+        if (i != center && (i - center) % 2 == 0)
+            h[i] = 0;
+    }
+    return h;
+}
+
+
+namespace resampler_detail {
+
+template<class T, class S>
+inline S dot(const T* h, const S* x, size_t n, size_t stride = 1)
+{
+    S acc = 0;
+    for (size_t i = 0; i < n; ++i)
+        acc += h[i] * x[i * stride];
+    return acc;
+}
+
+template<class C>
+inline C complex_dot(const decltype(C::re)* h, const C* x, size_t n, size_t stride = 1)
+{
+    decltype(C::re) re = 0, im = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        re += h[i] * x[i * stride].re;
+        im += h[i] * x[i * stride].im;
+    }
+    return {re, im};
+}
+
+inline Ipp32fc dot(const Ipp32f* h, const Ipp32fc* x, size_t n, size_t stride = 1) { return complex_dot(h, x, n, stride); }
+inline Ipp64fc dot(const Ipp64f* h, const Ipp64fc* x, size_t n, size_t stride = 1) { return complex_dot(h, x, n, stride); }
+
+// halfband branch: n taps at even offsets of x plus the center tap at x[center]
+template<class T, class S>
+inline S halfband_dot(const T* h, size_t n, T h_center, const S* x, size_t center)
+{
+    return dot(h, x, n, 2) + h_center * x[center];
+}
+
+template<class C>
+inline C complex_halfband_dot(const decltype(C::re)* h, size_t n, decltype(C::re) h_center, const C* x, size_t center)
+{
+    C acc = complex_dot(h, x, n, 2);
+    acc.re += h_center * x[center].re;
+    acc.im += h_center * x[center].im;
+    return acc;
+}
+
+inline Ipp32fc halfband_dot(const Ipp32f* h, size_t n, Ipp32f h_center, const Ipp32fc* x, size_t center)
+{
+    return complex_halfband_dot(h, n, h_center, x, center);
+}
+inline Ipp64fc halfband_dot(const Ipp64f* h, size_t n, Ipp64f h_center, const Ipp64fc* x, size_t center)
+{
+    return complex_halfband_dot(h, n, h_center, x, center);
+}
+
+}
+
+
+// Streaming rational resampler, polyphase form: conceptually upsample by up, filter at up * fs,
+// take every down-th sample. Only kept outputs are computed, each one is a dot product of
+// one polyphase branch (taps.size() / up taps) with the input history.
+// T is sample type (real or IPP complex), taps are real.
+// Decimation by 2 with halfband taps (design_halfband) skips the zero taps: each output takes
+// only the (taps + 1) / 2 even taps and the center one.
+// History is carried between process() calls, input is consumed in blocks of block_size samples
+template<class T>
+class Resampler
+{
+public:
+    using SamplesT = T;
+    using TapT     = ipp::BaseType<T>;
+
+    static constexpr size_t block_size = 4096;
+
+    // taps designed for rate up * fs, gain 1 at DC (they are scaled by up here)
+    Resampler(size_t up, size_t down, const std::vector<double>& taps)
+    {
+        if (up == 0 || down == 0)
+        {
+            throw std::invalid_argument("Resampler: zero rate factor");
+        }
+        size_t g = std::gcd(up, down);
+        up_      = up / g;
+        down_    = down / g;
+        taps_count_ = std::max<size_t>(taps.size(), 1);
+
+        // branch p holds taps[p + i * up], stored reversed to run forward over history
+        branch_size_ = (taps_count_ + up_ - 1) / up_;
+        branches_.assign(up_ * branch_size_, TapT(0));
+        for (size_t p = 0; p < up_; ++p)
+        {
+            for (size_t i = 0; i < branch_size_; ++i)
+            {
+                size_t k = p + i * up_;
+                if (k < taps.size())
+                    branches_[p * branch_size_ + branch_size_ - 1 - i] = static_cast<TapT>(taps[k] * up_);
+            }
+        }
+
+        init_halfband();
+
+        buffer_.resize(branch_size_ - 1 + block_size);
+        reset();
+    }
+
+    // lowpass at 0.45 / max(up, down) of the upsampled rate
+    Resampler(size_t up, size_t down, size_t taps_per_branch = 24, double beta = 8.6) :
+        Resampler(up, down, design_lowpass(taps_per_branch * (std::max(up, down) / std::gcd(up, down)) | 1,
+                                           0.45 / (std::max(up, down) / std::gcd(up, down)), beta))
+    {}
+
+    void reset()
+    {
+        std::fill(buffer_.begin(), buffer_.end(), T{});
+        phase_   = 0;
+        next_in_ = 0;
+    }
+
+    // upper bound of outputs for len more inputs
+    inline size_t max_output(size_t len) const { return (len * up_) / down_ + 1; }
+
+    inline size_t up() const { return up_; }
+    inline size_t down() const { return down_; }
+    inline double ratio() const { return double(up_) / down_; }
+    // group delay in output samples
+    inline double delay() const { return (taps_count_ - 1) / 2. / down_; }
+
+    // returns number of samples written to dst, dst must hold max_output(len)
+    size_t process(const T* src, size_t len, T* dst)
+    {
+        const size_t hist = branch_size_ - 1;
+        size_t produced = 0;
+
+        while (len > 0)
+        {
+            size_t n = std::min(len, block_size);
+            std::copy_n(src, n, buffer_.data() + hist);
+
+            if (!halfband_taps_.empty())
+            {
+                const size_t center = branch_size_ / 2;
+                for (; next_in_ < n; next_in_ += 2)
+                {
+                    dst[produced++] = resampler_detail::halfband_dot(halfband_taps_.data(), halfband_taps_.size(),
+                                                                     halfband_center_, buffer_.data() + next_in_,
+                                                                     center);
+                }
+            }
+
+            while (next_in_ < n)
+            {
+                const TapT* h = branches_.data() + phase_ * branch_size_;
+                dst[produced++] = resampler_detail::dot(h, buffer_.data() + next_in_, branch_size_);
+
+                phase_   += down_;
+                next_in_ += phase_ / up_;
+                phase_   %= up_;
+            }
+            next_in_ -= n;
+
+            std::copy_n(buffer_.data() + n, hist, buffer_.data());
+            src += n;
+            len -= n;
+        }
+        return produced;
+    }
+
+    template<class Alloc>
+    std::vector<T, Alloc> process(const std::vector<T, Alloc>& src)
+    {
+        std::vector<T, Alloc> ret(max_output(src.size()));
+        ret.resize(process(src.data(), src.size(), ret.data()));
+        return ret;
+    }
+
+private:
+    // 1:2 with 4k + 3 taps, zero at even distances from the center: keep the nonzero ones
+    void init_halfband()
+    {
+        if (up_ != 1 || down_ != 2 || branch_size_ % 4 != 3)
+            return;
+
+        const size_t center = branch_size_ / 2;
+        for (size_t i = 0; i < branch_size_; ++i)
+        {
+            if (i != center && (i - center) % 2 == 0 && branches_[i] != TapT(0))
+                return;
+        }
+        // center is odd, the other nonzero taps sit at even positions
+        for (size_t i = 0; i < branch_size_; i += 2)
+            halfband_taps_.push_back(branches_[i]);
+        halfband_center_ = branches_[center];
+    }
+
+    size_t up_;
+    size_t down_;
+    size_t taps_count_;
+    size_t branch_size_;
+
+    std::vector<TapT> branches_;
+    std::vector<TapT> halfband_taps_; // even taps of the branch, empty if not halfband
+    TapT halfband_center_ = 0;
+    std::vector<T> buffer_;
+
+    size_t phase_   = 0; // (k * down) mod up of next output k
+    size_t next_in_ = 0; // input of next output, relative to current block
+};
+
+
+template<class T>
+class Decimator : public Resampler<T>
+{
+public:
+    Decimator(size_t factor, const std::vector<double>& taps) :
+        Resampler<T>(1, factor, taps)
+    {}
+
+    explicit Decimator(size_t factor, size_t taps_per_branch = 24, double beta = 8.6) :
+        Resampler<T>(1, factor, taps_per_branch, beta)
+    {}
+};
+
+
+template<class T>
+class Interpolator : public Resampler<T>
+{
+public:
+    Interpolator(size_t factor, const std::vector<double>& taps) :
+        Resampler<T>(factor, 1, taps)
+    {}
+
+    explicit Interpolator(size_t factor, size_t taps_per_branch = 24, double beta = 8.6) :
+        Resampler<T>(factor, 1, taps_per_branch, beta)
+    {}
+};
+
+
+// Chain of resamplers, e.g. halfband decimators: each stage runs at its own input rate,
+// so most of the filtering happens at low rates with short filters
+template<class T>
+class ResamplerCascade
+{
+public:
+    ResamplerCascade() = default;
+
+    void add_stage(Resampler<T> stage)
+    {
+        stages_.push_back(std::move(stage));
+        buffers_.resize(stages_.size());
+    }
+
+    inline size_t stages() const { return stages_.size(); }
+    inline Resampler<T>& stage(size_t i) { return stages_.at(i); }
+
+    void reset()
+    {
+        for (auto& s : stages_)
+            s.reset();
+    }
+
+    inline double ratio() const
+    {
+        double r = 1;
+        for (auto& s : stages_)
+            r *= s.ratio();
+        return r;
+    }
+
+    // group delay in output samples
+    double delay() const
+    {
+        double d = 0;
+        for (auto& s : stages_)
+            d = d * s.ratio() + s.delay();
+        return d;
+    }
+
+    size_t max_output(size_t len) const
+    {
+        for (auto& s : stages_)
+            len = s.max_output(len);
+        return len;
+    }
+
+    size_t process(const T* src, size_t len, T* dst)
+    {
+        if (stages_.empty())
+        {
+            std::copy_n(src, len, dst);
+            return len;
+        }
+
+        for (size_t i = 0; i + 1 < stages_.size(); ++i)
+        {
+            auto& buf = buffers_[i];
+            buf.resize(std::max(buf.size(), stages_[i].max_output(len)));
+            len = stages_[i].process(src, len, buf.data());
+            src = buf.data();
+        }
+        return stages_.back().process(src, len, dst);
+    }
+
+    template<class Alloc>
+    std::vector<T, Alloc> process(const std::vector<T, Alloc>& src)
+    {
+        std::vector<T, Alloc> ret(max_output(src.size()));
+        ret.resize(process(src.data(), src.size(), ret.data()));
+        return ret;
+    }
+
+private:
+    std::vector<Resampler<T>> stages_;
+    std::vector<std::vector<T>> buffers_;
+};
+
+
+// factor = 2^k * rest: k halfband stages (zero taps skipped), then one polyphase decimator by rest
+template<class T>
+ResamplerCascade<T> make_decimator_cascade(size_t factor, size_t halfband_taps = 31, double beta = 8.6)
+{
+    if (factor == 0)
+    {
+        throw std::invalid_argument("make_decimator_cascade: zero factor");
+    }
+
+    ResamplerCascade<T> cascade;
+    auto halfband = design_halfband(halfband_taps, beta);
+    while (factor % 2 == 0)
+    {
+        cascade.add_stage(Decimator<T>(2, halfband));
+        factor /= 2;
+    }
+    if (factor > 1)
+        cascade.add_stage(Decimator<T>(factor));
+    return cascade;
+}
+
+
+// anti-aliased replacement for sample_down()
+template<class T, class Alloc>
+std::vector<T, Alloc> decimate(const std::vector<T, Alloc>& sig, size_t factor)
+{
+    return make_decimator_cascade<T>(factor).process(sig);
+}
+
+}
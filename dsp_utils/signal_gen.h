@@ -2,28 +2,34 @@
 
 
 #include "signal_types.h"
+#include "chirp.h"
 #include <cmath>
 
 namespace dsp_utils {
 namespace signal_gen
 {
-template <class Ttap>
-std::vector<std::complex<Ttap>> lfm(size_t sample_rate_Hz, double duration_s, double spec_width_Hz,
-                                    double cfreq_ofs_Hz = 0, double start_phase = 0)
+// start_phase is phase at the pulse center
+template <class Ttap, class Alloc = std::allocator<std::complex<Ttap>>>
+std::vector<std::complex<Ttap>, Alloc> lfm(size_t sample_rate_Hz, double duration_s, double spec_width_Hz,
+                                           double cfreq_ofs_Hz = 0, double start_phase = 0)
 {
-    double dt = 1. / sample_rate_Hz;
     double T = duration_s;
     double Tbegin = -T / 2;
-    size_t N = sample_rate_Hz * T;
-
-    std::vector<std::complex<Ttap>> ret;
-    for (size_t i = 0; i < N; ++i){
-        auto t = Tbegin + i * dt;
-        Ttap ang = M_PI * t * t / T * spec_width_Hz + start_phase + 2*M_PI * cfreq_ofs_Hz * t;
-        ang = std::fmod(ang, 2*M_PI);
-        ret.push_back(std::polar<Ttap>(Ttap(1), ang));
-    }
-    return ret;
+    double first_phase = M_PI * Tbegin * Tbegin / T * spec_width_Hz + start_phase + 2*M_PI * cfreq_ofs_Hz * Tbegin;
+
+    Chirp<Ttap> chirp(sample_rate_Hz, T, spec_width_Hz, cfreq_ofs_Hz, first_phase);
+    return chirp.template generate<Alloc>(chirp.size());
+}
+
+// nonlinear FM, frequency_law(t) gives instantaneous frequency in Hz, t in [0, duration_s].
+// resync: samples per parabolic segment, see Chirp
+template <class Ttap, class Alloc = std::allocator<std::complex<Ttap>>>
+std::vector<std::complex<Ttap>, Alloc> nlfm(size_t sample_rate_Hz, double duration_s,
+                                            typename Chirp<Ttap>::FrequencyLaw frequency_law, double start_phase = 0,
+                                            size_t resync = Chirp<Ttap>::default_nlfm_resync)
+{
+    Chirp<Ttap> chirp(sample_rate_Hz, duration_s, std::move(frequency_law), start_phase, resync);
+    return chirp.template generate<Alloc>(chirp.size());
 }
 
 
@@ -9,6 +9,8 @@
 
 #include <ipp.h>
 
+#include "wrappers/ipp_alloc.h"
+
 namespace dsp_utils {
 
 using  complex_32f = std::complex<Ipp32f>;
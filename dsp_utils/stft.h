@@ -0,0 +1,167 @@
+#pragma once
+
+#include "signal_types.h"
+#include "window.h"
+
+#include "wrappers/ipp_alloc.h"
+#include "wrappers/ipp_fft.h"
+#include "wrappers/ipp_linear.h"
+#include "wrappers/ipp_transforms.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace dsp_utils {
+
+// Streaming spectrogram: window -> FFT -> |X|^2 -> 10*log10, frame by frame.
+// Frames are window.size() samples long, taken every hop samples; spectrum is zero padded
+// up to the next power of two. dB rows go to a preallocated ring of rows() rows,
+// nothing is allocated after construction
+template<class T>
+class STFT
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    STFT(const window::Taps<T>& window, size_t hop, size_t rows = 64, T min_power = T(1e-20)) :
+        frame_size_(window.size()),
+        hop_(std::max<size_t>(hop, 1)),
+        rows_(std::max<size_t>(rows, 1)),
+        min_power_(min_power),
+        fft_(ipp::fft_order_ceil(frame_size_)),
+        window_(window)
+    {
+        if (frame_size_ == 0)
+        {
+            throw std::invalid_argument("STFT: empty window");
+        }
+
+        frame_    = ipp::allocate_managed<SamplesT>(frame_size_);
+        work_     = ipp::allocate_managed<SamplesT>(fft_.size());
+        spectrum_ = ipp::allocate_managed<T>(fft_.size() * rows_);
+
+        ipp::zero(work_.get(), fft_.size());
+
+        reset();
+    }
+
+    STFT(const std::vector<T>& window, size_t hop, size_t rows = 64, T min_power = T(1e-20)) :
+        STFT(copy_window(window), hop, rows, min_power)
+    {}
+
+    // Taylor window from the shared cache
+    STFT(size_t frame_size, size_t hop, size_t rows = 64) :
+        STFT(window::cached<T>(window::Type::Taylor, frame_size), hop, rows)
+    {}
+
+    void reset()
+    {
+        fill_   = 0;
+        skip_   = 0;
+        frames_ = 0;
+    }
+
+    // returns number of rows produced by this call
+    size_t push(const SamplesT* src, size_t len)
+    {
+        size_t produced = 0;
+
+        while (len > 0)
+        {
+            if (skip_ > 0)
+            {
+                size_t n = std::min(skip_, len);
+                skip_ -= n;
+                src   += n;
+                len   -= n;
+                continue;
+            }
+
+            size_t n = std::min(len, frame_size_ - fill_);
+            ipp::copy(src, frame_.get() + fill_, n);
+            fill_ += n;
+            src   += n;
+            len   -= n;
+
+            if (fill_ == frame_size_)
+            {
+                process_frame();
+                ++produced;
+
+                if (hop_ < frame_size_)
+                {
+                    // overlapping ranges, dst before src
+                    std::copy(frame_.get() + hop_, frame_.get() + frame_size_, frame_.get());
+                    fill_ = frame_size_ - hop_;
+                }
+                else
+                {
+                    fill_ = 0;
+                    skip_ = hop_ - frame_size_;
+                }
+            }
+        }
+        return produced;
+    }
+
+    // total frames produced since reset
+    inline size_t frames() const { return frames_; }
+
+    // dB row of frame with absolute index; valid for the last rows() frames only
+    inline const T* row(size_t frame_index) const
+    {
+        return spectrum_.get() + (frame_index % rows_) * fft_.size();
+    }
+
+    inline const T* latest() const { return row(frames_ - 1); }
+
+    inline size_t row_size() const { return fft_.size(); }
+    inline size_t rows() const { return rows_; }
+    inline size_t hop() const { return hop_; }
+    inline size_t frame_size() const { return frame_size_; }
+
+private:
+
+    static window::Taps<T> copy_window(const std::vector<T>& window)
+    {
+        auto taps = ipp::allocate_managed_shared<T>(std::max<size_t>(window.size(), 1));
+        ipp::copy(window.data(), taps.get(), window.size());
+        return window::Taps<T>(std::const_pointer_cast<const T>(taps), window.size());
+    }
+
+    void process_frame()
+    {
+        T* dst = spectrum_.get() + (frames_ % rows_) * fft_.size();
+
+        window::apply(window_.data(), frame_.get(), work_.get(), frame_size_);
+        fft_.forward(work_.get());
+
+        ipp::power_spectrum(work_.get(), dst, fft_.size());
+        ipp::threshold_less_than(min_power_, dst, fft_.size());
+        ipp::log10(dst, fft_.size());
+        ipp::mul_const(T(10), dst, fft_.size());
+
+        // zero padding tail is overwritten by FFT output
+        ipp::zero(work_.get() + frame_size_, fft_.size() - frame_size_);
+
+        ++frames_;
+    }
+
+    size_t frame_size_;
+    size_t hop_;
+    size_t rows_;
+    T min_power_;
+
+    size_t fill_   = 0;
+    size_t skip_   = 0;
+    size_t frames_ = 0;
+
+    ipp::FFT<T> fft_;
+    window::Taps<T> window_;
+
+    ipp::managed_sequence_ptr<SamplesT> frame_    = nullptr;
+    ipp::managed_sequence_ptr<SamplesT> work_     = nullptr;
+    ipp::managed_sequence_ptr<T> spectrum_        = nullptr;
+};
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dsp_utils {
+
+inline size_t default_concurrency()
+{
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+// Fixed set of workers executing indexed tasks.
+// run() blocks caller until every task is done; worker index passed to task
+// is stable in [0, size()) so it can be used to pick per-thread buffers.
+// run() called from inside a task of the same pool executes inline on the calling worker
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threads = default_concurrency())
+    {
+        threads = std::max<size_t>(threads, 1);
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this, i]{ worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_)
+        {
+            w.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // calls f(task_index, worker_index) for every task_index in [0, tasks)
+    template<class FuncT>
+    void run(size_t tasks, FuncT&& f)
+    {
+        if (tasks == 0)
+            return;
+
+        // nested call: workers are busy with the outer job, waiting on them would deadlock
+        auto& ctx = context();
+        if (ctx.pool == this)
+        {
+            for (size_t task = 0; task < tasks; ++task)
+                f(task, ctx.worker);
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+        std::function<void(size_t, size_t)> job = [&f](size_t task, size_t worker){ f(task, worker); };
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_    = &job;
+        tasks_  = tasks;
+        next_   = 0;
+        active_ = workers_.size();
+        error_  = nullptr;
+        ++generation_;
+        cv_.notify_all();
+
+        done_cv_.wait(lock, [this]{ return active_ == 0; });
+        job_ = nullptr;
+
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    inline size_t size() const { return workers_.size(); }
+
+    static ThreadPool& global()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+
+    struct WorkerContext
+    {
+        const ThreadPool* pool = nullptr;
+        size_t worker          = 0;
+    };
+
+    static WorkerContext& context()
+    {
+        thread_local WorkerContext ctx;
+        return ctx;
+    }
+
+    void worker_loop(size_t worker)
+    {
+        context() = {this, worker};
+
+        size_t seen_generation = 0;
+        while (true)
+        {
+            std::function<void(size_t, size_t)>* job;
+            size_t tasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&]{ return stop_ || generation_ != seen_generation; });
+                if (stop_)
+                    return;
+                seen_generation = generation_;
+                job             = job_;
+                tasks           = tasks_;
+            }
+
+            for (size_t task = next_.fetch_add(1); task < tasks; task = next_.fetch_add(1))
+            {
+                try
+                {
+                    (*job)(task, worker);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_)
+                        error_ = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0)
+                done_cv_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+
+    std::function<void(size_t, size_t)>* job_ = nullptr;
+    size_t tasks_                             = 0;
+    size_t active_                            = 0;
+    size_t generation_                        = 0;
+    std::atomic<size_t> next_                 = 0;
+    std::exception_ptr error_                 = nullptr;
+    bool stop_                                = false;
+};
+
+
+// splits [0, count) into ranges of at most grain elements,
+// calls f(begin, end, worker_index) for each
+template<class FuncT>
+inline void parallel_for(ThreadPool& pool, size_t count, size_t grain, FuncT&& f)
+{
+    grain        = std::max<size_t>(grain, 1);
+    size_t tasks = (count + grain - 1) / grain;
+
+    pool.run(tasks, [&](size_t task, size_t worker){
+        size_t begin = task * grain;
+        size_t end   = std::min(begin + grain, count);
+        f(begin, end, worker);
+    });
+}
+
+}
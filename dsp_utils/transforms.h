@@ -4,10 +4,14 @@
 #pragma once
 
 #include "signal_types.h"
+#include "moving_average.h"
+#include "moments.h"
+
+#include "wrappers/ipp_arena.h"
 
 #include <algorithm>
-#include <iostream>
 #include <numeric>
+#include <stdexcept>
 
 
 namespace dsp_utils {
@@ -48,15 +52,15 @@ int64_t signum(T&& val){
 
 
 
-template <class T>
-std::vector<T> normalize(const std::vector<T>& sig, double norm = 1)
+template <class T, class Alloc>
+std::vector<T, Alloc> normalize(const std::vector<T, Alloc>& sig, double norm = 1)
 {
     if (sig.size() == 0)
         return {};
 
-    double ABS = std::abs(*max_element(begin(sig), end(sig), [](auto&& x, auto&& y){return abs(x) < abs(y);}));
+    double ABS = moments(sig).max_abs();
 
-    std::vector<T> ret(sig.size());
+    std::vector<T, Alloc> ret(sig.size());
     transform(begin(sig), end(sig), begin(ret),
               [ABS, norm](const T& x)->T{return x / T(ABS) * T(norm);});
 
@@ -64,10 +68,11 @@ std::vector<T> normalize(const std::vector<T>& sig, double norm = 1)
 }
 
 
-template <class T>
-std::vector<T> sample_down(const std::vector<T>& sig, int dec = 1, int start_phase = 0)
+// plain sample picking, no anti-alias filtering: see decimate() / Decimator in resampler.h
+template <class T, class Alloc>
+std::vector<T, Alloc> sample_down(const std::vector<T, Alloc>& sig, int dec = 1, int start_phase = 0)
 {
-    std::vector<T> ret; ret.reserve(sig.size() / dec);
+    std::vector<T, Alloc> ret; ret.reserve(sig.size() / dec);
     for (size_t pos = start_phase; pos < sig.size(); pos += dec)
         ret.push_back(sig[pos]);
     return ret;
@@ -75,28 +80,18 @@ std::vector<T> sample_down(const std::vector<T>& sig, int dec = 1, int start_pha
 
 
 
-template<class T>
-std::vector<T> running_mean(const std::vector<T>& sig, size_t smooth_cnt)
+// sig.size() - smooth_cnt + 1 means of full windows, see MovingAverage for streaming version
+template<class T, class Alloc>
+std::vector<T, Alloc> running_mean(const std::vector<T, Alloc>& sig, size_t smooth_cnt)
 {
-    if (sig.size() < smooth_cnt)
+    if (smooth_cnt == 0 || sig.size() < smooth_cnt)
         return {};
-    std::vector<T> ret(0);
 
-    std::cerr << sig.size() - smooth_cnt + 1 << std::endl;
+    std::vector<T, Alloc> ret(sig.size());
 
-    ret.reserve(sig.size() - smooth_cnt + 1);
+    MovingAverage<T>(smooth_cnt).process(sig.data(), ret.data(), sig.size());
 
-    T sum {0};
-
-    for (size_t i = 0; i < smooth_cnt; ++i)
-        sum += sig[i];
-
-    for (size_t i = smooth_cnt; i < sig.size(); ++i)
-    {
-        ret.push_back(sum / smooth_cnt);
-        sum += sig[i];
-        sum -= sig[i-smooth_cnt];
-    }
+    ret.erase(begin(ret), begin(ret) + smooth_cnt - 1);
 
     return ret;
 
@@ -106,10 +101,12 @@ std::vector<T> running_mean(const std::vector<T>& sig, size_t smooth_cnt)
 
 
 
-template<class T, class FuncT>
-auto map_sequence(const std::vector<T>& sig, FuncT f){
+// result uses allocator of sig rebound to the mapped type
+template<class T, class Alloc, class FuncT>
+auto map_sequence(const std::vector<T, Alloc>& sig, FuncT f){
 //    static_assert (std::is_invocable<FuncT, T>::value, "sequenct can't map! types mismatch");
-    std::vector<typename std::result_of_t<FuncT(T)>> ret;
+    using R = typename std::result_of_t<FuncT(T)>;
+    std::vector<R, typename std::allocator_traits<Alloc>::template rebind_alloc<R>> ret;
     ret.reserve(sig.size());
     for (auto&& v : sig){
         ret.push_back(f(v));
@@ -119,8 +116,8 @@ auto map_sequence(const std::vector<T>& sig, FuncT f){
 
 
 
-template <class T>
-std::tuple<std::vector<uint64_t>, T, T> histogram_impl(const std::vector<T>& sig, size_t bins)
+template <class T, class Alloc>
+std::tuple<std::vector<uint64_t>, T, T> histogram_impl(const std::vector<T, Alloc>& sig, size_t bins)
 {
     static_assert (is_real_v<T>, "only real signals supported!");
     auto min_max_it = std::minmax_element(begin(sig), end(sig));
@@ -129,11 +126,12 @@ std::tuple<std::vector<uint64_t>, T, T> histogram_impl(const std::vector<T>& sig
     auto max_i = min_max_it.second;
 
     auto step = static_cast<double>(*max_i - *min_i) / bins;
+    auto inv_step = step > 0 ? 1. / step : 0.;
 
     std::vector<uint64_t> ret(bins + 1, 0);
 
     for (T x : sig){
-        ret[size_t((x - *min_i) / step)]++;
+        ret[size_t((x - *min_i) * inv_step)]++;
     }
 
     return {ret, *min_i, *max_i};
@@ -146,16 +144,56 @@ std::tuple<std::vector<uint64_t>, T, T> histogram_impl(const std::vector<T>& sig
 //}
 
 
-template <class T>
-auto median(const std::vector<T>& sig, size_t skip_first = 0, size_t skip_last = 0)
+namespace transforms_detail {
+
+template <class T, class Alloc>
+T select(std::vector<T, Alloc>& tmp, size_t I)
+{
+    if (I >= tmp.size())
+        return tmp.at(I);
+
+    std::nth_element(begin(tmp), begin(tmp) + I, end(tmp));
+    return tmp[I];
+}
+
+// element I of sorted sig; working copy lives in arena if one is given, on the heap otherwise
+template <class T, class Alloc>
+T select_copy(const std::vector<T, Alloc>& sig, size_t I, ipp::ScratchArena* arena)
 {
-    std::vector<T> tmp(sig.size());
-    std::copy(begin(sig), end(sig), begin(tmp));
-    std::sort(begin(tmp), end(tmp));
+    if (arena){
+        ipp::ArenaScope scope(*arena);
+        std::vector<T, ipp::ArenaAllocator<T>> tmp(begin(sig), end(sig), ipp::ArenaAllocator<T>(*arena));
+        return select(tmp, I);
+    }
+    std::vector<T> tmp(begin(sig), end(sig));
+    return select(tmp, I);
+}
+
+}
 
+
+// element of rank q * (size - skip_first - skip_last) among sorted values, counting from skip_first.
+// O(n) selection instead of full sort. arena: optional scratch for the working copy
+// (e.g. &ipp::ScratchArena::local() in a frame loop), it keeps its chunks after the call
+template <class T, class Alloc>
+auto quantile(const std::vector<T, Alloc>& sig, double q, size_t skip_first = 0, size_t skip_last = 0,
+              ipp::ScratchArena* arena = nullptr)
+{
+    size_t rest_size = sig.size() - skip_first - skip_last;
+    size_t I = std::min(static_cast<size_t>(q * rest_size), rest_size - 1) + skip_first;
+
+    return transforms_detail::select_copy(sig, I, arena);
+}
+
+
+template <class T, class Alloc>
+auto median(const std::vector<T, Alloc>& sig, size_t skip_first = 0, size_t skip_last = 0,
+            ipp::ScratchArena* arena = nullptr)
+{
     size_t rest_size = sig.size() - skip_first - skip_last;
     size_t I = rest_size / 2 + skip_first;
-    return tmp.at(I);
+
+    return transforms_detail::select_copy(sig, I, arena);
 }
 
 
@@ -175,25 +213,25 @@ inline int fft_order_floor(uint64_t size){
 
 
 
-template <class T>
-std::vector<T> fftshift(const std::vector<T>& x){
-    std::vector<T> ret(x.size());
+template <class T, class Alloc>
+std::vector<T, Alloc> fftshift(const std::vector<T, Alloc>& x){
+    std::vector<T, Alloc> ret(x.size());
     std::rotate_copy(begin(x), begin(x) + x.size() / 2, end(x), begin(ret));
     return ret;
 }
 
-template <class Tout, class InIter>
-std::vector<Tout> abs(InIter begin, InIter end){
-    std::vector<Tout> ret;
+template <class Tout, class InIter, class Alloc = std::allocator<Tout>>
+std::vector<Tout, Alloc> abs(InIter begin, InIter end){
+    std::vector<Tout, Alloc> ret;
     std::transform(begin, end, back_inserter(ret), [](auto&& x)->Tout{return std::abs<Tout>(x);});
     return ret;
 }
 
 
-template <class T>
-std::vector<T> clip(const std::vector<T>& s, T lo, T hi){
+template <class T, class Alloc>
+std::vector<T, Alloc> clip(const std::vector<T, Alloc>& s, T lo, T hi){
     static_assert (is_real_v<T>, "only real signal supported");
-    std::vector<T> ret(s.size());
+    std::vector<T, Alloc> ret(s.size());
     std::transform(begin(s), end(s), begin(ret), [lo, hi](auto&& x){return std::min(std::max(x, lo), hi);});
     return ret;
 }
@@ -202,8 +240,8 @@ std::vector<T> clip(const std::vector<T>& s, T lo, T hi){
 
 
 
-template <class T>
-int64_t argmax(const std::vector<T>& s){
+template <class T, class Alloc>
+int64_t argmax(const std::vector<T, Alloc>& s){
     return std::max_element(begin(s), end(s)) - begin(s);
 }
 
@@ -245,29 +283,25 @@ struct IppCorr<double>{
 
 
 
-template <class T>
-T mean(const std::vector<T>& s){
+template <class T, class Alloc>
+T mean(const std::vector<T, Alloc>& s){
     if (s.empty())
         return T(0);
-    return std::accumulate(begin(s), end(s), T(0)) / s.size();
+    return moments_detail::store<T>(moments(s).mean);
 }
 
-template <class T>
-double var(const std::vector<T>& s){
-    auto M = mean(s);
-    double ret = 0;
-    for (auto x : s){
-        double dx = std::abs(x - M);
-        ret += dx * dx;
-    }
-    return ret / s.size();
+template <class T, class Alloc>
+double var(const std::vector<T, Alloc>& s){
+    return moments(s).variance();
 }
 
 
-template <class T>
-std::vector<T> norm(std::vector<T> s){
-    auto M = mean(s);
-    auto stdV = std::sqrt(var(s));
+// (s - mean) / std: one pass for moments, one for normalization
+template <class T, class Alloc>
+std::vector<T, Alloc> norm(std::vector<T, Alloc> s){
+    auto m = moments(s);
+    T M = moments_detail::store<T>(m.mean);
+    auto stdV = m.stddev();
     for (auto& x : s){
         x -= M;
         x /= stdV;
@@ -276,40 +310,77 @@ std::vector<T> norm(std::vector<T> s){
 }
 
 
-inline std::vector<Ipp32fc> norm(std::vector<Ipp32fc> s, IppHintAlgorithm alg = ippAlgHintFast){
-    Ipp32fc M;
-    ippsMean_32fc(s.data(), s.size(), &M, alg);
-    ippsSubC_32fc_I(M, s.data(), s.size());
-
-    double var = 0;
-    for (auto x : s){
-        var += x.re * x.re + x.im * x.im;
-    }
-    var /= s.size();
-
-    ippsDivC_32f_I(float(std::sqrt(var)),
-                   reinterpret_cast<float*>(s.data()),
-                   s.size() * 2);
+// Ipp32fc: moments pass, then subtract and scale fused in one ippsNormalize pass.
+// rvalue input is normalized in place, lvalue input goes straight into a new vector without copying
+template <class Alloc>
+std::vector<Ipp32fc, Alloc> norm(std::vector<Ipp32fc, Alloc>&& s){
+    auto m = moments(s);
+    ippsNormalize_32fc_I(s.data(), s.size(), moments_detail::store<Ipp32fc>(m.mean), float(m.stddev()));
+    return std::move(s);
+}
 
-    return s;
+template <class Alloc>
+std::vector<Ipp32fc, Alloc> norm(const std::vector<Ipp32fc, Alloc>& s){
+    auto m = moments(s);
+    std::vector<Ipp32fc, Alloc> res(s.size(), s.get_allocator());
+    ippsNormalize_32fc(s.data(), res.data(), s.size(), moments_detail::store<Ipp32fc>(m.mean), float(m.stddev()));
+    return res;
 }
 
 
 
 
+// Cross-correlation with fixed sizes: IPP work buffer is taken once, from the thread's BufferPool.
+// Not thread-safe, use one object per thread
 template <class T>
-std::vector<T> correlate(const std::vector<T>& a, const std::vector<T>& b, size_t corr_size, long low_lag=0,
-                    IppEnum flags = ippAlgFFT | ippsNormNone)
-{
-    int buff_sz = 0;
-    ippsCrossCorrNormGetBufferSize(a.size(), b.size(), corr_size, low_lag,
-                                   IppCorr<T>::data_type, flags, &buff_sz);
+class Correlator{
+public:
+    Correlator(size_t a_size, size_t b_size, size_t corr_size, long low_lag = 0,
+               IppEnum flags = ippAlgFFT | ippsNormNone):
+        a_size_(a_size), b_size_(b_size), corr_size_(corr_size), low_lag_(low_lag), flags_(flags)
+    {
+        int buff_sz = 0;
+        ippsCrossCorrNormGetBufferSize(a_size_, b_size_, corr_size_, low_lag_,
+                                       IppCorr<T>::data_type, flags_, &buff_sz);
+        buffer_ = ipp::PooledBuffer<Ipp8u>(buff_sz);
+    }
+
+    // a: a_size(), b: b_size(), dst: corr_size() samples
+    void correlate(const T* a, const T* b, T* dst){
+        IppCorr<T>::correlate(a, a_size_, b, b_size_, dst, corr_size_, low_lag_, flags_, buffer_.get());
+    }
+
+    template <class AllocA, class AllocB, class AllocDst>
+    void correlate(const std::vector<T, AllocA>& a, const std::vector<T, AllocB>& b, std::vector<T, AllocDst>& dst){
+        if (a.size() != a_size_ || b.size() != b_size_){
+            throw std::range_error("input sizes differ from Correlator sizes");
+        }
+        dst.resize(corr_size_);
+        correlate(a.data(), b.data(), dst.data());
+    }
+
+    inline size_t a_size() const { return a_size_; }
+    inline size_t b_size() const { return b_size_; }
+    inline size_t corr_size() const { return corr_size_; }
+    inline long low_lag() const { return low_lag_; }
+
+private:
+    size_t a_size_;
+    size_t b_size_;
+    size_t corr_size_;
+    long low_lag_;
+    IppEnum flags_;
+    ipp::PooledBuffer<Ipp8u> buffer_;
+};
 
-    std::vector<Ipp8u> buffer(buff_sz);
 
-    std::vector<T> ret(corr_size);
+template <class T, class Alloc>
+std::vector<T, Alloc> correlate(const std::vector<T, Alloc>& a, const std::vector<T, Alloc>& b, size_t corr_size,
+                                long low_lag=0, IppEnum flags = ippAlgFFT | ippsNormNone)
+{
+    std::vector<T, Alloc> ret(corr_size);
 
-    IppCorr<T>::correlate(a.data(), a.size(), b.data(), b.size(), ret.data(), ret.size(), low_lag, flags, buffer.data());
+    Correlator<T>(a.size(), b.size(), corr_size, low_lag, flags).correlate(a.data(), b.data(), ret.data());
 
     return ret;
 
@@ -2,26 +2,87 @@
 
 #include "signal_types.h"
 
+#include "wrappers/ipp_alloc.h"
+#include "wrappers/ipp_linear.h"
+
 #include <cmath>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <memory>
+#include <initializer_list>
 
 namespace dsp_utils{
 namespace window
 {
+
+// All windows are periodic (DFT-even): sample i is taken at i / N of the period
+enum class Type {
+    Hann,
+    Hamming,
+    BlackmanHarris,
+    Kaiser,   // param1: beta, default 8.6
+    FlatTop,
+    Taylor    // param1: SSL (dB), default -55; param2: number of lobes, default 9
+};
+
+namespace detail {
+
+// sum_k (-1)^k a_k cos(2 pi k i / N), cos(k x) by Chebyshev recurrence
 template <class T>
-std::vector<T> taylor(size_t N, double SSL = -55, size_t N_lobes = 9)
+void cosine_sum(T* dst, size_t N, std::initializer_list<double> coeffs)
 {
-    static_assert (is_real_v<T>, "only real signals supported!");
-    auto sqr = [](auto&& x){return x * x;};
+    const double* a = coeffs.begin();
+    for (size_t i = 0; i < N; ++i){
+        double c1 = std::cos(2 * M_PI * double(i) / N);
+        double prev = 1, cur = c1;
+        double tap = a[0], sign = -1;
+        for (size_t k = 1; k < coeffs.size(); ++k){
+            tap += sign * a[k] * cur;
+            sign = -sign;
+            double next = 2 * c1 * cur - prev;
+            prev = cur;
+            cur = next;
+        }
+        dst[i] = static_cast<T>(tap);
+    }
+}
+
+inline double bessel_i0(double x)
+{
+    double term = 1, sum = 1, q = x * x / 4;
+    for (int k = 1; k < 500 && term > sum * 1e-17; ++k){
+        term *= q / (double(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+template <class T>
+void kaiser(T* dst, size_t N, double beta)
+{
+    double norm = 1. / bessel_i0(beta);
+    for (size_t i = 0; i < N; ++i){
+        double t = 2. * i / N - 1;
+        dst[i] = static_cast<T>(bessel_i0(beta * std::sqrt(std::max(0., 1 - t * t))) * norm);
+    }
+}
 
+template <class T>
+void taylor(T* dst, size_t N, double SSL, size_t N_lobes)
+{
+    auto sqr = [](auto&& x){return x * x;};
 
     double D =  std::acosh(std::pow(10., -SSL / 20.)) / M_PI;
     double SS = sqr(N_lobes) / (sqr(D) + sqr(N_lobes - 0.5));
 
     std::vector<double> FF;
 
-    for (int i = 1; i < N_lobes; ++i){
+    for (int i = 1; i < int(N_lobes); ++i){
         double val = (i % 2) ? 1 : -1;
-        for (int j = 1; j < N_lobes; ++j)
+        for (int j = 1; j < int(N_lobes); ++j)
         {
             val *= (1. - sqr(i) / (SS * (sqr(D) + sqr(j-0.5))));
             if (i != j){
@@ -31,23 +92,212 @@ std::vector<T> taylor(size_t N, double SSL = -55, size_t N_lobes = 9)
         FF.push_back(val / 2);
     }
 
-
-    std::vector<T> taps;
-
+    // cos(m x), x = 2 pi (i / N - 0.5), by Chebyshev recurrence: one std::cos per tap
     for (size_t i = 0; i < N; ++i){
-        int m = 1;
-        double t = -0.5 + double(i) / N;
+        double c1 = std::cos((-0.5 + double(i) / N) * 2 * M_PI);
+        double prev = 1, cur = c1;
         double tap = 0;
         for (auto k : FF){
-            tap += k * std::cos( m * t * 2 * M_PI  );
-            ++m;
+            tap += k * cur;
+            double next = 2 * c1 * cur - prev;
+            prev = cur;
+            cur = next;
         }
-        taps.push_back(static_cast<T>(tap * 2 + 1));
+        dst[i] = static_cast<T>(tap * 2 + 1);
+    }
+}
+
+// nan parameters are replaced by defaults, unused ones are zeroed: equal windows get equal keys
+inline std::pair<double, double> resolve(Type type, double param1, double param2)
+{
+    switch (type){
+    case Type::Kaiser:
+        return {std::isnan(param1) ? 8.6 : param1, 0};
+    case Type::Taylor:
+        return {std::isnan(param1) ? -55 : param1, std::isnan(param2) ? 9 : std::round(param2)};
+    default:
+        return {0, 0};
+    }
+}
+
+}
+
+template <class T>
+void generate(Type type, T* dst, size_t N, double param1 = std::nan(""), double param2 = std::nan(""))
+{
+    static_assert (is_real_v<T>, "only real signals supported!");
 
+    auto p = detail::resolve(type, param1, param2);
+    switch (type){
+    case Type::Hann:
+        detail::cosine_sum(dst, N, {0.5, 0.5});
+        break;
+    case Type::Hamming:
+        detail::cosine_sum(dst, N, {0.54, 0.46});
+        break;
+    case Type::BlackmanHarris:
+        detail::cosine_sum(dst, N, {0.35875, 0.48829, 0.14128, 0.01168});
+        break;
+    case Type::FlatTop:
+        detail::cosine_sum(dst, N, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368});
+        break;
+    case Type::Kaiser:
+        detail::kaiser(dst, N, p.first);
+        break;
+    case Type::Taylor:
+        detail::taylor(dst, N, p.first, static_cast<size_t>(p.second));
+        break;
     }
+}
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> generate(Type type, size_t N, double param1 = std::nan(""), double param2 = std::nan(""))
+{
+    std::vector<T, Alloc> taps(N);
+    generate(type, taps.data(), N, param1, param2);
     return taps;
 }
 
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> hann(size_t N) { return generate<T, Alloc>(Type::Hann, N); }
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> hamming(size_t N) { return generate<T, Alloc>(Type::Hamming, N); }
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> blackman_harris(size_t N) { return generate<T, Alloc>(Type::BlackmanHarris, N); }
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> flat_top(size_t N) { return generate<T, Alloc>(Type::FlatTop, N); }
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> kaiser(size_t N, double beta = 8.6) { return generate<T, Alloc>(Type::Kaiser, N, beta); }
+
+template <class T, class Alloc = std::allocator<T>>
+std::vector<T, Alloc> taylor(size_t N, double SSL = -55, size_t N_lobes = 9)
+{
+    return generate<T, Alloc>(Type::Taylor, N, SSL, double(N_lobes));
+}
+
+
+// read-only taps in IPP-aligned storage, shared between all users of the same window
+template <class T>
+class Taps
+{
+public:
+    Taps() = default;
+    Taps(std::shared_ptr<const T> taps, size_t size) :
+        taps_(std::move(taps)), size_(size)
+    {}
+
+    inline const T* data() const { return taps_.get(); }
+    inline size_t size() const { return size_; }
+    inline T operator[](size_t i) const { return taps_.get()[i]; }
+    inline const T* begin() const { return data(); }
+    inline const T* end() const { return data() + size_; }
+
+private:
+    std::shared_ptr<const T> taps_;
+    size_t size_ = 0;
+};
+
+
+// process-wide cache keyed by (type, N, parameters)
+template <class T>
+class WindowCache
+{
+public:
+    static WindowCache& instance()
+    {
+        static WindowCache cache;
+        return cache;
+    }
+
+    Taps<T> get(Type type, size_t N, double param1 = std::nan(""), double param2 = std::nan(""))
+    {
+        auto p   = detail::resolve(type, param1, param2);
+        auto key = std::make_tuple(type, N, p.first, p.second);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = windows_.find(key);
+        if (it != windows_.end())
+        {
+            ++hits_;
+            return it->second;
+        }
+
+        ++misses_;
+        auto taps = ipp::allocate_managed_shared<T>(std::max<size_t>(N, 1));
+        generate(type, taps.get(), N, p.first, p.second);
+
+        Taps<T> ret(std::const_pointer_cast<const T>(taps), N);
+        windows_.emplace(key, ret);
+        return ret;
+    }
+
+    // taps still referenced by users stay alive
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        windows_.clear();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return windows_.size();
+    }
+
+    inline size_t hits() const { return hits_; }
+    inline size_t misses() const { return misses_; }
+
+private:
+    WindowCache() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::tuple<Type, size_t, double, double>, Taps<T>> windows_;
+    std::atomic<size_t> hits_   = 0;
+    std::atomic<size_t> misses_ = 0;
+};
+
+template <class T>
+Taps<T> cached(Type type, size_t N, double param1 = std::nan(""), double param2 = std::nan(""))
+{
+    return WindowCache<T>::instance().get(type, N, param1, param2);
+}
+
+
+// frame[i] *= taps[i]
+template <class T>
+inline void apply(const T* taps, T* frame, size_t len)
+{
+    ipp::mul(taps, frame, len);
+}
+
+template <class T>
+inline void apply(const T* taps, ipp::Complex<T>* frame, size_t len)
+{
+    ipp::mul_by_real(taps, frame, len);
+}
+
+// dst[i] = src[i] * taps[i]
+template <class T>
+inline void apply(const T* taps, const T* src, T* dst, size_t len)
+{
+    ipp::mul(taps, src, dst, len);
+}
+
+template <class T>
+inline void apply(const T* taps, const ipp::Complex<T>* src, ipp::Complex<T>* dst, size_t len)
+{
+    ipp::mul_by_real(taps, src, dst, len);
+}
+
+template <class T, class FrameT>
+inline void apply(const Taps<T>& taps, FrameT* frame)
+{
+    apply(taps.data(), frame, taps.size());
+}
 
 }
 }
@@ -3,7 +3,9 @@
 #include "ipp_types.h"
 
 #include <memory>
-#include <functional>
+#include <vector>
+#include <limits>
+#include <new>
 
 namespace dsp_utils
 {
@@ -20,7 +22,7 @@ struct IppAllocHelper;
 MAKE_HELPER(Ipp32f, 32f)
 MAKE_HELPER(Ipp32fc, 32fc)
 MAKE_HELPER(Ipp64f, 64f)
-MAKE_HELPER(Ipp64fc, 32fc)
+MAKE_HELPER(Ipp64fc, 64fc)
 
 MAKE_HELPER(Ipp16sc, 16sc)
 MAKE_HELPER(Ipp8u, 8u)
@@ -32,8 +34,17 @@ MAKE_HELPER(Ipp32u, 32u)
 #undef MAKE_HELPER
 
 
+// stateless deleter: managed_sequence_ptr is one pointer wide
+struct IppFree
+{
+    void operator()(void* ptr) const noexcept
+    {
+        ippsFree(ptr);
+    }
+};
+
 template <class T>
-using managed_sequence_ptr = std::unique_ptr<T[], std::function<void(T*)>>;
+using managed_sequence_ptr = std::unique_ptr<T[], IppFree>;
 
 
 template <class T>
@@ -45,7 +56,7 @@ T* allocate(std::size_t count){
 template <class T>
 managed_sequence_ptr<T> allocate_managed(std::size_t count)
 {
-    return managed_sequence_ptr<T>(allocate<T>(count), ippsFree);
+    return managed_sequence_ptr<T>(allocate<T>(count));
 }
 
 template <class T>
@@ -54,9 +65,64 @@ std::shared_ptr<T> allocate_managed_shared(std::size_t count)
     return std::shared_ptr<T>(allocate<T>(count), ippsFree);
 }
 
+inline Ipp8u* allocate_bytes(std::size_t bytes)
+{
+    if (bytes > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    {
+        throw std::bad_array_new_length();
+    }
+
+    auto ptr = ippsMalloc_8u(static_cast<int>(bytes));
+    if (ptr == nullptr && bytes > 0)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+
+// Standard allocator on top of ippsMalloc: 64-byte aligned storage for any T,
+// sized in bytes, so it does not depend on IppAllocHelper mapping
+template <class T>
+struct IppAllocator
+{
+    using value_type = T;
+
+    static constexpr std::size_t alignment = 64;
+
+    IppAllocator() noexcept = default;
+
+    template <class U>
+    IppAllocator(const IppAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count)
+    {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+        {
+            throw std::bad_array_new_length();
+        }
+        return reinterpret_cast<T*>(allocate_bytes(count * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept
+    {
+        ippsFree(ptr);
+    }
+};
+
+template <class T, class U>
+inline bool operator==(const IppAllocator<T>&, const IppAllocator<U>&) noexcept { return true; }
+
+template <class T, class U>
+inline bool operator!=(const IppAllocator<T>&, const IppAllocator<U>&) noexcept { return false; }
+
 
 
 
 }
 
+// std::vector with IPP-aligned storage
+template <class T>
+using Signal = std::vector<T, ipp::IppAllocator<T>>;
+
 }
@@ -0,0 +1,399 @@
+#pragma once
+
+#include "ipp_types.h"
+#include "ipp_alloc.h"
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace dsp_utils
+{
+namespace ipp {
+
+// Bump allocator over large ippsMalloc chunks, all allocations 64-byte aligned.
+// Memory is given back only by rewind()/reset(): mark at frame start, rewind at frame end
+// (see ArenaScope). reset() after a frame that spilled into several chunks replaces them
+// with one chunk of high-water size, so steady-state frames never touch the heap.
+// Not thread-safe, use local() -- one arena per thread
+class ScratchArena
+{
+public:
+    static constexpr std::size_t alignment     = 64;
+    static constexpr std::size_t default_chunk = 1 << 20;
+
+    struct Marker
+    {
+        std::size_t chunk;
+        std::size_t offset;
+        std::size_t used;
+    };
+
+    explicit ScratchArena(std::size_t chunk_size = default_chunk) :
+        chunk_size_(std::max(round_up(chunk_size), alignment))
+    {}
+
+    ~ScratchArena()
+    {
+        release_chunks();
+    }
+
+    ScratchArena(const ScratchArena&)            = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    static ScratchArena& local()
+    {
+        thread_local ScratchArena arena;
+        return arena;
+    }
+
+    template <class T>
+    T* allocate(std::size_t count)
+    {
+        return reinterpret_cast<T*>(allocate_bytes(count * sizeof(T)));
+    }
+
+    void* allocate_bytes(std::size_t bytes)
+    {
+        bytes = round_up(std::max<std::size_t>(bytes, 1));
+
+        if (chunks_.empty() || offset_ + bytes > chunks_[chunk_].size)
+            next_chunk(bytes);
+
+        void* ptr = chunks_[chunk_].data + offset_;
+        offset_ += bytes;
+        used_   += bytes;
+        high_water_ = std::max(high_water_, used_);
+        return ptr;
+    }
+
+    inline Marker mark() const { return {chunk_, offset_, used_}; }
+
+    void rewind(const Marker& marker)
+    {
+        chunk_  = marker.chunk;
+        offset_ = marker.offset;
+        used_   = marker.used;
+    }
+
+    void reset()
+    {
+        if (chunks_.size() > 1)
+        {
+            release_chunks();
+            add_chunk(std::max(chunk_size_, high_water_));
+        }
+        rewind({0, 0, 0});
+    }
+
+    // bytes handed out since last reset / rewind point, including alignment padding
+    inline std::size_t used() const { return used_; }
+    inline std::size_t high_water() const { return high_water_; }
+    inline std::size_t heap_allocations() const { return heap_allocations_; }
+
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for (auto& c : chunks_)
+            total += c.size;
+        return total;
+    }
+
+private:
+    struct Chunk
+    {
+        Ipp8u* data;
+        std::size_t size;
+    };
+
+    static std::size_t round_up(std::size_t bytes)
+    {
+        return (bytes + alignment - 1) / alignment * alignment;
+    }
+
+    // bytes left in current chunk are skipped until rewind
+    void next_chunk(std::size_t bytes)
+    {
+        std::size_t next = chunks_.empty() ? 0 : chunk_ + 1;
+        while (next < chunks_.size() && chunks_[next].size < bytes)
+            ++next;
+
+        if (next == chunks_.size())
+            add_chunk(std::max(chunk_size_, bytes));
+
+        if (next > 0)
+            used_ += chunks_[chunk_].size - offset_;
+        chunk_  = next;
+        offset_ = 0;
+    }
+
+    void add_chunk(std::size_t bytes)
+    {
+        chunks_.push_back({ipp::allocate_bytes(bytes), bytes});
+        ++heap_allocations_;
+    }
+
+    void release_chunks()
+    {
+        for (auto& c : chunks_)
+            ippsFree(c.data);
+        chunks_.clear();
+    }
+
+    std::size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    std::size_t chunk_            = 0;
+    std::size_t offset_           = 0;
+    std::size_t used_             = 0;
+    std::size_t high_water_       = 0;
+    std::size_t heap_allocations_ = 0;
+};
+
+
+// rewinds arena to the state it had at construction
+class ArenaScope
+{
+public:
+    explicit ArenaScope(ScratchArena& arena = ScratchArena::local()) :
+        arena_(arena), marker_(arena.mark())
+    {}
+
+    ~ArenaScope()
+    {
+        arena_.rewind(marker_);
+    }
+
+    ArenaScope(const ArenaScope&)            = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    inline ScratchArena& arena() { return arena_; }
+
+private:
+    ScratchArena& arena_;
+    ScratchArena::Marker marker_;
+};
+
+
+// STL allocator for frame temporaries: deallocate is a no-op, memory returns on rewind
+template <class T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() noexcept :
+        arena(&ScratchArena::local())
+    {}
+
+    explicit ArenaAllocator(ScratchArena& a) noexcept :
+        arena(&a)
+    {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept :
+        arena(other.arena)
+    {}
+
+    T* allocate(std::size_t count) { return arena->allocate<T>(count); }
+    void deallocate(T*, std::size_t) noexcept {}
+
+    ScratchArena* arena;
+};
+
+template <class T, class U>
+inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.arena == b.arena; }
+
+template <class T, class U>
+inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept { return a.arena != b.arena; }
+
+
+// Power-of-two size classes (from 64 bytes) with free lists, for long-lived scratch such as
+// FFT work buffers: released blocks are reused instead of going back to ippsFree.
+// Thread-safe, so a buffer may be released on another thread than it was acquired on;
+// local() gives one pool per thread to keep the lock uncontended
+class BufferPool
+{
+public:
+    static constexpr std::size_t min_class = 6;
+    static constexpr std::size_t classes   = 31;
+
+    BufferPool() :
+        free_(classes)
+    {}
+
+    ~BufferPool()
+    {
+        trim();
+    }
+
+    BufferPool(const BufferPool&)            = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    static const std::shared_ptr<BufferPool>& local()
+    {
+        thread_local std::shared_ptr<BufferPool> pool = std::make_shared<BufferPool>();
+        return pool;
+    }
+
+    void* acquire(std::size_t bytes)
+    {
+        if (bytes == 0)
+            return nullptr;
+
+        std::size_t cls = size_class(bytes);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        outstanding_ += std::size_t(1) << cls;
+        high_water_   = std::max(high_water_, outstanding_);
+
+        auto& list = free_[cls];
+        if (!list.empty())
+        {
+            void* ptr = list.back();
+            list.pop_back();
+            cached_ -= std::size_t(1) << cls;
+            ++hits_;
+            return ptr;
+        }
+
+        ++misses_;
+        return ipp::allocate_bytes(std::size_t(1) << cls);
+    }
+
+    void release(void* ptr, std::size_t bytes)
+    {
+        if (ptr == nullptr)
+            return;
+
+        std::size_t cls = size_class(bytes);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_[cls].push_back(ptr);
+        outstanding_ -= std::size_t(1) << cls;
+        cached_      += std::size_t(1) << cls;
+    }
+
+    // frees all cached blocks
+    void trim()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& list : free_)
+        {
+            for (void* ptr : list)
+                ippsFree(ptr);
+            list.clear();
+        }
+        cached_ = 0;
+    }
+
+    // hits: served from free lists, misses: went to ippsMalloc
+    inline std::size_t hits() const { std::lock_guard<std::mutex> lock(mutex_); return hits_; }
+    inline std::size_t misses() const { std::lock_guard<std::mutex> lock(mutex_); return misses_; }
+    inline std::size_t outstanding() const { std::lock_guard<std::mutex> lock(mutex_); return outstanding_; }
+    inline std::size_t high_water() const { std::lock_guard<std::mutex> lock(mutex_); return high_water_; }
+    inline std::size_t cached() const { std::lock_guard<std::mutex> lock(mutex_); return cached_; }
+
+private:
+    static std::size_t size_class(std::size_t bytes)
+    {
+        std::size_t cls = min_class;
+        while ((std::size_t(1) << cls) < bytes)
+            ++cls;
+        if (cls >= classes)
+        {
+            throw std::bad_array_new_length();
+        }
+        return cls;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::vector<void*>> free_;
+    std::size_t hits_        = 0;
+    std::size_t misses_      = 0;
+    std::size_t outstanding_ = 0;
+    std::size_t high_water_  = 0;
+    std::size_t cached_      = 0;
+};
+
+
+// count elements of T from a BufferPool, given back on destruction. Copy takes a new block
+// from the same pool and copies contents
+template <class T>
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+
+    explicit PooledBuffer(std::size_t count, std::shared_ptr<BufferPool> pool = BufferPool::local()) :
+        pool_(std::move(pool)),
+        data_(static_cast<T*>(pool_->acquire(count * sizeof(T)))),
+        size_(count)
+    {}
+
+    ~PooledBuffer()
+    {
+        release();
+    }
+
+    PooledBuffer(const PooledBuffer& other) :
+        PooledBuffer(other.size_, other.pool_ ? other.pool_ : BufferPool::local())
+    {
+        if (size_ > 0)
+            std::memcpy(data_, other.data_, size_ * sizeof(T));
+    }
+
+    PooledBuffer(PooledBuffer&& other) noexcept :
+        pool_(std::move(other.pool_)),
+        data_(other.data_),
+        size_(other.size_)
+    {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    PooledBuffer& operator=(const PooledBuffer& other)
+    {
+        if (this != &other)
+        {
+            PooledBuffer tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            pool_       = std::move(other.pool_);
+            data_       = other.data_;
+            size_       = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    inline T* get() const { return data_; }
+    inline std::size_t size() const { return size_; }
+    inline T& operator[](std::size_t i) const { return data_[i]; }
+
+private:
+    void release()
+    {
+        if (pool_ && data_)
+            pool_->release(data_, size_ * sizeof(T));
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    std::shared_ptr<BufferPool> pool_ = nullptr;
+    T* data_                          = nullptr;
+    std::size_t size_                 = 0;
+};
+
+}
+
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "ipp_types.h"
+#include "ipp_alloc.h"
+#include "ipp_linear.h"
+#include "ipp_fft.h"
+#include "ipp_arena.h"
+
+#include <chrono>
+#include <variant>
+#include <vector>
+
+namespace dsp_utils {
+
+namespace ipp {
+
+template<class T>
+struct DFTHelper;
+
+#define MAKE_HELPER(type_name, suffix) template<>                         \
+    struct DFTHelper<type_name>                                           \
+    {                                                                     \
+        using spec_type = IppsDFTSpec_C_ ## suffix;                       \
+                                                                          \
+        static constexpr auto get_buff_size = ippsDFTGetSize_C_ ## suffix; \
+        static constexpr auto init          = ippsDFTInit_C_ ## suffix;   \
+        static constexpr auto forward       = ippsDFTFwd_CToC_ ## suffix; \
+        static constexpr auto backward      = ippsDFTInv_CToC_ ## suffix; \
+    };
+
+MAKE_HELPER(Ipp32fc, 32fc)
+MAKE_HELPER(Ipp64fc, 64fc)
+
+#undef MAKE_HELPER
+
+
+// Immutable DFT spec, shared like FFTPlan: each user needs own work buffer
+template<class Helper>
+class DFTPlan
+{
+public:
+    using spec_type = typename Helper::spec_type;
+
+    DFTPlan(size_t length, FFTNormMode norm) :
+        length_(length), norm_(norm)
+    {
+        int specdata_sz, specbuff_sz, workbuff_sz;
+
+        Helper::get_buff_size(length_,
+                              norm_,
+                              ippAlgHintFast,
+                              &specdata_sz,
+                              &specbuff_sz,
+                              &workbuff_sz);
+
+        workBuff_size_ = workbuff_sz;
+        specData_      = allocate_managed<Ipp8u>(specdata_sz);
+
+        // init buffer is needed only while spec is built
+        auto specBuff = allocate_managed<Ipp8u>(std::max(specbuff_sz, 1));
+
+        pDFTSpec_ = reinterpret_cast<spec_type*>(specData_.get());
+        Helper::init(length_, norm_, ippAlgHintFast, pDFTSpec_, specBuff.get());
+    }
+
+    DFTPlan(const DFTPlan&)            = delete;
+    DFTPlan& operator=(const DFTPlan&) = delete;
+
+    inline const spec_type* spec() const { return pDFTSpec_; }
+    inline size_t work_size() const { return workBuff_size_; }
+    inline FFTNormMode norm() const { return norm_; }
+    inline size_t size() const { return length_; }
+
+private:
+    size_t length_;
+    FFTNormMode norm_;
+    size_t workBuff_size_;
+    managed_sequence_ptr<Ipp8u> specData_ = nullptr;
+    spec_type* pDFTSpec_                  = nullptr;
+};
+
+template<class Helper>
+using DFTPlanCache = FFTPlanCache<Helper, DFTPlan<Helper>>;
+
+
+// DFT of arbitrary length. Same interface as FFT, but constructed from length, not order.
+// Spec comes from DFTPlanCache, buffers from the thread's BufferPool: once both are warm,
+// constructing a DFT of an already seen length does not call ippsMalloc
+template<class T>
+class DFT
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+    using PlanT    = DFTPlan<DFTHelper<SamplesT>>;
+
+    DFT(size_t length = 1000, FFTNormMode norm = NORM_NONE) :
+        DFT(DFTPlanCache<DFTHelper<SamplesT>>::instance().get(length, norm))
+    {}
+
+    explicit DFT(std::shared_ptr<const PlanT> plan) :
+        plan_(std::move(plan)),
+        workBuff_(plan_->work_size()),
+        tmpBuff_(plan_->size())
+    {}
+
+    ~DFT()     = default;
+    DFT(DFT&&) = default;
+    DFT(const DFT& other) :
+        DFT(other.plan_)
+    {}
+
+    DFT& operator=(DFT&&) = default;
+    DFT& operator=(const DFT& other)
+    {
+        DFT tmp(other);
+
+        *this = std::move(tmp);
+        return *this;
+    }
+
+    void forward(const ipp::Complex<T>* src, ipp::Complex<T>* dst)
+    {
+        DFTHelper<SamplesT>::forward(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    void forward(ipp::Complex<T>* srcDst)
+    {
+        DFTHelper<SamplesT>::forward(srcDst, tmpBuff_.get(), plan_->spec(), workBuff_.get());
+        ipp::copy(tmpBuff_.get(), srcDst, plan_->size());
+    }
+
+    void backward(const ipp::Complex<T>* src, ipp::Complex<T>* dst)
+    {
+        DFTHelper<SamplesT>::backward(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    void backward(ipp::Complex<T>* srcDst)
+    {
+        DFTHelper<SamplesT>::backward(srcDst, tmpBuff_.get(), plan_->spec(), workBuff_.get());
+        ipp::copy(tmpBuff_.get(), srcDst, plan_->size());
+    }
+
+    inline size_t size() const { return plan_->size(); }
+
+private:
+    std::shared_ptr<const PlanT> plan_;
+    PooledBuffer<Ipp8u> workBuff_;
+    PooledBuffer<SamplesT> tmpBuff_;
+};
+
+
+// FFT or DFT behind one interface, see make_transform().
+// size() is the transform length: with padding allowed it may exceed the requested one
+template<class T>
+class SpectralTransform
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    SpectralTransform(FFT<T> fft) : impl_(std::move(fft)) {}
+    SpectralTransform(DFT<T> dft) : impl_(std::move(dft)) {}
+
+    void forward(const SamplesT* src, SamplesT* dst)
+    {
+        std::visit([&](auto& t){ t.forward(src, dst); }, impl_);
+    }
+
+    void forward(SamplesT* srcDst)
+    {
+        std::visit([&](auto& t){ t.forward(srcDst); }, impl_);
+    }
+
+    void backward(const SamplesT* src, SamplesT* dst)
+    {
+        std::visit([&](auto& t){ t.backward(src, dst); }, impl_);
+    }
+
+    void backward(SamplesT* srcDst)
+    {
+        std::visit([&](auto& t){ t.backward(srcDst); }, impl_);
+    }
+
+    inline size_t size() const
+    {
+        return std::visit([](auto& t){ return t.size(); }, impl_);
+    }
+
+    inline bool is_fft() const { return std::holds_alternative<FFT<T>>(impl_); }
+
+private:
+    std::variant<FFT<T>, DFT<T>> impl_;
+};
+
+
+// average seconds per forward transform
+template<class TransformT>
+inline double measure_transform_cost(TransformT& transform, size_t trials = 16)
+{
+    using SamplesT = typename TransformT::SamplesT;
+
+    auto buff = allocate_managed<SamplesT>(transform.size());
+    zero(buff.get(), transform.size());
+
+    transform.forward(buff.get()); // warm up
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trials; ++i)
+    {
+        transform.forward(buff.get());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / std::max<size_t>(trials, 1);
+}
+
+
+// Transform of exactly length points: FFT for powers of two, DFT otherwise.
+// allow_padding: FFT of next power of two is also considered and taken if measured faster;
+// then size() > length and the caller must zero-pad frames (bins are on the size() grid)
+template<class T>
+inline SpectralTransform<T> make_transform(size_t length, FFTNormMode norm = NORM_NONE, bool allow_padding = false,
+                                           size_t trials = 16)
+{
+    size_t order = fft_order_ceil(length);
+
+    if ((size_t(1) << order) == length)
+    {
+        return FFT<T>(order, norm);
+    }
+
+    DFT<T> dft(length, norm);
+    if (!allow_padding)
+    {
+        return SpectralTransform<T>(std::move(dft));
+    }
+
+    FFT<T> fft(order, norm);
+    if (measure_transform_cost(fft, trials) < measure_transform_cost(dft, trials))
+    {
+        return SpectralTransform<T>(std::move(fft));
+    }
+    return SpectralTransform<T>(std::move(dft));
+}
+
+}
+
+}
@@ -2,8 +2,12 @@
 
 #include "ipp_types.h"
 #include "ipp_alloc.h"
+#include "ipp_arena.h"
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <atomic>
 
 namespace dsp_utils {
 
@@ -50,6 +54,33 @@ struct FFTHelper<Ipp64fc>
     static constexpr auto backward_implace = ippsFFTInv_CToC_64fc_I;
 };
 
+
+template<class T>
+struct FFTRealHelper;
+
+#define MAKE_HELPER(type_name, suffix) template<>                                           \
+    struct FFTRealHelper<type_name>                                                         \
+    {                                                                                       \
+        using spec_type = IppsFFTSpec_R_ ## suffix;                                         \
+                                                                                            \
+        static constexpr auto get_buff_size         = ippsFFTGetSize_R_ ## suffix;          \
+        static constexpr auto init                  = ippsFFTInit_R_ ## suffix;             \
+        static constexpr auto forward_perm          = ippsFFTFwd_RToPerm_ ## suffix;        \
+        static constexpr auto forward_perm_implace  = ippsFFTFwd_RToPerm_ ## suffix ## _I;  \
+        static constexpr auto forward_ccs           = ippsFFTFwd_RToCCS_ ## suffix;         \
+        static constexpr auto forward_pack          = ippsFFTFwd_RToPack_ ## suffix;        \
+                                                                                            \
+        static constexpr auto backward_perm         = ippsFFTInv_PermToR_ ## suffix;        \
+        static constexpr auto backward_perm_implace = ippsFFTInv_PermToR_ ## suffix ## _I;  \
+        static constexpr auto backward_ccs          = ippsFFTInv_CCSToR_ ## suffix;         \
+        static constexpr auto backward_pack         = ippsFFTInv_PackToR_ ## suffix;        \
+    };
+
+MAKE_HELPER(Ipp32f, 32f)
+MAKE_HELPER(Ipp64f, 64f)
+
+#undef MAKE_HELPER
+
 inline size_t fft_order_ceil(size_t size)
 {
     size_t order = 0;
@@ -82,49 +113,136 @@ inline void fft_shift(T* srcDst, size_t size)
     std::rotate(srcDst, srcDst + size / 2, srcDst + size);
 }
 
-template<class T>
-class FFT
+// Immutable FFT spec. Safe to share between threads, each user needs own work buffer
+template<class Helper>
+class FFTPlan
 {
 public:
-    using SamplesT                          = ipp::Complex<T>;
-    FFT(size_t order = 10, FFTNormMode norm = NORM_NONE) :
-        order_(order)
+    using spec_type = typename Helper::spec_type;
+
+    FFTPlan(size_t order, FFTNormMode norm) :
+        order_(order), norm_(norm)
     {
         int specdata_sz, specbuff_sz, workbuff_sz;
 
-        ipp::FFTHelper<SamplesT>::get_buff_size(order_,
-                                                norm,
-                                                ippAlgHintFast,
-                                                &specdata_sz,
-                                                &specbuff_sz,
-                                                &workbuff_sz);
-
+        Helper::get_buff_size(order_,
+                              norm_,
+                              ippAlgHintFast,
+                              &specdata_sz,
+                              &specbuff_sz,
+                              &workbuff_sz);
 
         workBuff_size_ = workbuff_sz;
-        specData_      = allocate_managed_shared<Ipp8u>(specdata_sz);
-        specBuff_      = allocate_managed_shared<Ipp8u>(specbuff_sz);
-        workBuff_      = allocate_managed<Ipp8u>(workBuff_size_);
+        specData_      = allocate_managed<Ipp8u>(specdata_sz);
 
+        // init buffer is needed only while spec is built
+        auto specBuff = allocate_managed<Ipp8u>(std::max(specbuff_sz, 1));
+
+        Helper::init(&pFFTSpec_, order_,
+                     norm_,
+                     ippAlgHintFast, specData_.get(), specBuff.get());
+    }
 
+    FFTPlan(const FFTPlan&)            = delete;
+    FFTPlan& operator=(const FFTPlan&) = delete;
 
-        ipp::FFTHelper<SamplesT>::init(&pFFTSpec_, order_,
-                                       norm,
-                                       ippAlgHintFast, specData_.get(), specBuff_.get());
+    inline const spec_type* spec() const { return pFFTSpec_; }
+    inline size_t work_size() const { return workBuff_size_; }
+    inline size_t order() const { return order_; }
+    inline FFTNormMode norm() const { return norm_; }
+    inline size_t size() const { return 1ll << order_; }
+
+private:
+    size_t order_;
+    FFTNormMode norm_;
+    size_t workBuff_size_;
+    managed_sequence_ptr<Ipp8u> specData_ = nullptr;
+    spec_type* pFFTSpec_                  = nullptr;
+};
+
+
+// Process-wide plans storage. One instance per helper (i.e. per sample type) and plan type,
+// plans are looked up by (order, norm); DFT plans (see DFTPlanCache) by (length, norm)
+template<class Helper, class Plan = FFTPlan<Helper>>
+class FFTPlanCache
+{
+public:
+    using PlanT = Plan;
+
+    static FFTPlanCache& instance()
+    {
+        static FFTPlanCache cache;
+        return cache;
     }
 
-    ~FFT()     = default;
-    FFT(FFT&&) = default;
-    FFT(const FFT& other)
+    std::shared_ptr<const PlanT> get(size_t order, FFTNormMode norm)
     {
-        order_         = other.order_;
-        workBuff_size_ = other.workBuff_size_;
-        specBuff_      = other.specBuff_;
-        workBuff_      = allocate_managed<Ipp8u>(workBuff_size_);
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto key = std::make_pair(order, norm);
+        auto it  = plans_.find(key);
+        if (it != plans_.end())
+        {
+            ++hits_;
+            return it->second;
+        }
+
+        ++misses_;
+        auto plan = std::make_shared<const PlanT>(order, norm);
+        plans_.emplace(key, plan);
+        return plan;
+    }
 
-        // shared buffers -- same pointer!!!
-        pFFTSpec_ = other.pFFTSpec_;
+    // plans still referenced by FFT objects stay alive
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plans_.clear();
     }
 
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return plans_.size();
+    }
+
+    inline size_t hits() const { return hits_; }
+    inline size_t misses() const { return misses_; }
+
+private:
+    FFTPlanCache() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::pair<size_t, FFTNormMode>, std::shared_ptr<const PlanT>> plans_;
+    std::atomic<size_t> hits_   = 0;
+    std::atomic<size_t> misses_ = 0;
+};
+
+
+template<class T>
+class FFT
+{
+public:
+    using SamplesT                          = ipp::Complex<T>;
+    using PlanT                             = FFTPlan<FFTHelper<SamplesT>>;
+
+    FFT(size_t order = 10, FFTNormMode norm = NORM_NONE) :
+        FFT(FFTPlanCache<FFTHelper<SamplesT>>::instance().get(order, norm))
+    {}
+
+    // work buffer comes from the thread's BufferPool: recreating transforms of the same size
+    // in a processing loop reuses released blocks instead of calling ippsMalloc
+    explicit FFT(std::shared_ptr<const PlanT> plan) :
+        plan_(std::move(plan)),
+        workBuff_(plan_->work_size())
+    {}
+
+    ~FFT()     = default;
+    FFT(FFT&&) = default;
+    FFT(const FFT& other) :
+        FFT(other.plan_)
+    {}
+
     FFT& operator=(FFT&&) = default;
     FFT& operator=(const FFT& other)
     {
@@ -136,34 +254,149 @@ public:
 
     void forward(const ipp::Complex<T>* src, ipp::Complex<T>* dst)
     {
-        FFTHelper<SamplesT>::forward(src, dst, pFFTSpec_, workBuff_.get());
+        FFTHelper<SamplesT>::forward(src, dst, plan_->spec(), workBuff_.get());
     }
 
     void forward(ipp::Complex<T>* srcDst)
     {
-        FFTHelper<SamplesT>::forward_implace(srcDst, pFFTSpec_, workBuff_.get());
+        FFTHelper<SamplesT>::forward_implace(srcDst, plan_->spec(), workBuff_.get());
     }
 
     void backward(const ipp::Complex<T>* src, ipp::Complex<T>* dst)
     {
-        FFTHelper<SamplesT>::backward(src, dst, pFFTSpec_, workBuff_.get());
+        FFTHelper<SamplesT>::backward(src, dst, plan_->spec(), workBuff_.get());
     }
 
     void backward(ipp::Complex<T>* srcDst)
     {
-        FFTHelper<SamplesT>::backward_implace(srcDst, pFFTSpec_, workBuff_.get());
+        FFTHelper<SamplesT>::backward_implace(srcDst, plan_->spec(), workBuff_.get());
     }
 
-    inline size_t size() const { return 1ll << order_; }
+    inline size_t size() const { return plan_->size(); }
+    inline const std::shared_ptr<const PlanT>& plan() const { return plan_; }
 
 private:
 
-    size_t order_;
-    size_t workBuff_size_;
-    managed_sequence_ptr<Ipp8u> workBuff_              = nullptr;
-    std::shared_ptr<Ipp8u> specBuff_                   = nullptr;
-    std::shared_ptr<Ipp8u> specData_                   = nullptr;
-    typename FFTHelper<SamplesT>::spec_type* pFFTSpec_ = nullptr;
+    std::shared_ptr<const PlanT> plan_    = nullptr;
+    PooledBuffer<Ipp8u> workBuff_;
+};
+
+
+// Perm:  [Re0, Re(N/2), Re1, Im1, ..., Re(N/2-1), Im(N/2-1)]  -- N reals, in-place friendly
+// CCS:   [Re0, 0, Re1, Im1, ..., Re(N/2), 0]                   -- N/2+1 complex bins
+// Pack:  [Re0, Re1, Im1, ..., Re(N/2-1), Im(N/2-1), Re(N/2)]   -- N reals
+
+// unpack Perm spectrum of N real samples into N/2+1 complex bins (CCS layout)
+template<class T>
+inline void perm_to_half_spectrum(const T* perm, Complex<T>* dst, size_t N)
+{
+    dst[0]     = { perm[0], 0 };
+    dst[N / 2] = { perm[1], 0 };
+
+    for (size_t k = 1; k < N / 2; ++k)
+    {
+        dst[k] = { perm[2 * k], perm[2 * k + 1] };
+    }
+}
+
+// unpack Pack spectrum of N real samples into N/2+1 complex bins (CCS layout)
+template<class T>
+inline void pack_to_half_spectrum(const T* pack, Complex<T>* dst, size_t N)
+{
+    dst[0]     = { pack[0], 0 };
+    dst[N / 2] = { pack[N - 1], 0 };
+
+    for (size_t k = 1; k < N / 2; ++k)
+    {
+        dst[k] = { pack[2 * k - 1], pack[2 * k] };
+    }
+}
+
+// FFT of real signal: only N/2+1 bins are computed & stored.
+// Half spectrum (CCS) can be passed directly to power_spectrum()/log10()
+template<class T>
+class RealFFT
+{
+public:
+    using SamplesT = T;
+    using SpectrumT = ipp::Complex<T>;
+    using PlanT = FFTPlan<FFTRealHelper<SamplesT>>;
+
+    RealFFT(size_t order = 10, FFTNormMode norm = NORM_NONE) :
+        RealFFT(FFTPlanCache<FFTRealHelper<SamplesT>>::instance().get(order, norm))
+    {}
+
+    explicit RealFFT(std::shared_ptr<const PlanT> plan) :
+        plan_(std::move(plan)),
+        workBuff_(plan_->work_size())
+    {}
+
+    ~RealFFT()         = default;
+    RealFFT(RealFFT&&) = default;
+    RealFFT(const RealFFT& other) :
+        RealFFT(other.plan_)
+    {}
+
+    RealFFT& operator=(RealFFT&&) = default;
+    RealFFT& operator=(const RealFFT& other)
+    {
+        RealFFT tmp(other);
+
+        *this = std::move(tmp);
+        return *this;
+    }
+
+    // Perm format, size() reals
+    void forward(const T* src, T* dst)
+    {
+        FFTRealHelper<SamplesT>::forward_perm(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    void forward(T* srcDst)
+    {
+        FFTRealHelper<SamplesT>::forward_perm_implace(srcDst, plan_->spec(), workBuff_.get());
+    }
+
+    // CCS format, spectrum_size() complex bins
+    void forward(const T* src, SpectrumT* dst)
+    {
+        FFTRealHelper<SamplesT>::forward_ccs(src, reinterpret_cast<T*>(dst), plan_->spec(), workBuff_.get());
+    }
+
+    // Pack format, size() reals
+    void forward_pack(const T* src, T* dst)
+    {
+        FFTRealHelper<SamplesT>::forward_pack(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    void backward(const T* src, T* dst)
+    {
+        FFTRealHelper<SamplesT>::backward_perm(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    void backward(T* srcDst)
+    {
+        FFTRealHelper<SamplesT>::backward_perm_implace(srcDst, plan_->spec(), workBuff_.get());
+    }
+
+    void backward(const SpectrumT* src, T* dst)
+    {
+        FFTRealHelper<SamplesT>::backward_ccs(reinterpret_cast<const T*>(src), dst, plan_->spec(), workBuff_.get());
+    }
+
+    void backward_pack(const T* src, T* dst)
+    {
+        FFTRealHelper<SamplesT>::backward_pack(src, dst, plan_->spec(), workBuff_.get());
+    }
+
+    inline size_t size() const { return plan_->size(); }
+    inline size_t spectrum_size() const { return size() / 2 + 1; }
+    inline const std::shared_ptr<const PlanT>& plan() const { return plan_; }
+
+private:
+
+    std::shared_ptr<const PlanT> plan_    = nullptr;
+    PooledBuffer<Ipp8u> workBuff_;
 };
 
 }
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "ipp_fft.h"
+#include "ipp_linear.h"
+
+#include "../thread_pool.h"
+
+#include <chrono>
+#include <vector>
+
+namespace dsp_utils {
+
+namespace ipp {
+
+struct BatchStats
+{
+    size_t frames  = 0;
+    size_t threads = 0;
+    double seconds = 0;
+
+    inline double frames_per_second() const { return seconds > 0 ? frames / seconds : 0; }
+};
+
+
+// Runs many independent frames through one shared FFT plan.
+// Frames are rows of a matrix: frame i starts at ptr + i * stride.
+// Each worker of the pool owns its FFT (own work buffer) and gets slices of
+// frames small enough to stay in cache
+template<class T>
+class FFTBatch
+{
+public:
+    using SamplesT = ipp::Complex<T>;
+
+    FFTBatch(size_t order, FFTNormMode norm = NORM_NONE,
+             ThreadPool& pool = ThreadPool::global(),
+             size_t cache_bytes = 256 * 1024) :
+        pool_(&pool), cache_bytes_(cache_bytes)
+    {
+        FFT<T> fft(order, norm);
+        ffts_.resize(pool_->size(), fft);
+    }
+
+    void forward(const SamplesT* src, size_t src_stride, SamplesT* dst, size_t dst_stride, size_t frames)
+    {
+        execute(frames, [=](FFT<T>& fft, size_t i){
+            fft.forward(src + i * src_stride, dst + i * dst_stride);
+        });
+    }
+
+    void forward(SamplesT* srcDst, size_t stride, size_t frames)
+    {
+        execute(frames, [=](FFT<T>& fft, size_t i){
+            fft.forward(srcDst + i * stride);
+        });
+    }
+
+    void backward(const SamplesT* src, size_t src_stride, SamplesT* dst, size_t dst_stride, size_t frames)
+    {
+        execute(frames, [=](FFT<T>& fft, size_t i){
+            fft.backward(src + i * src_stride, dst + i * dst_stride);
+        });
+    }
+
+    void backward(SamplesT* srcDst, size_t stride, size_t frames)
+    {
+        execute(frames, [=](FFT<T>& fft, size_t i){
+            fft.backward(srcDst + i * stride);
+        });
+    }
+
+    // frames processed by one task: src + dst of a slice fits into cache_bytes,
+    // but every worker gets at least one slice
+    size_t frames_per_task(size_t frames) const
+    {
+        size_t frame_bytes = 2 * size() * sizeof(SamplesT);
+        size_t by_cache    = std::max<size_t>(cache_bytes_ / frame_bytes, 1);
+        size_t by_threads  = std::max<size_t>((frames + pool_->size() - 1) / pool_->size(), 1);
+        return std::min(by_cache, by_threads);
+    }
+
+    inline size_t size() const { return ffts_.front().size(); }
+    inline size_t threads() const { return pool_->size(); }
+
+    // timing of the last call
+    inline const BatchStats& stats() const { return stats_; }
+
+private:
+
+    template<class FuncT>
+    void execute(size_t frames, FuncT&& f)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        parallel_for(*pool_, frames, frames_per_task(frames),
+                     [&](size_t begin, size_t end, size_t worker){
+            auto& fft = ffts_[worker];
+            for (size_t i = begin; i < end; ++i)
+            {
+                f(fft, i);
+            }
+        });
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        stats_.frames  = frames;
+        stats_.threads = pool_->size();
+        stats_.seconds = elapsed.count();
+    }
+
+    ThreadPool* pool_;
+    size_t cache_bytes_;
+    std::vector<FFT<T>> ffts_;
+    BatchStats stats_;
+};
+
+
+// frames/s of forward in-place batch for every thread count
+template<class T>
+std::vector<BatchStats> fft_batch_scaling(size_t order, size_t frames,
+                                          const std::vector<size_t>& thread_counts,
+                                          size_t repeats = 4)
+{
+    size_t N    = size_t(1) << order;
+    auto buffer = allocate_managed<Complex<T>>(N * frames);
+    zero(buffer.get(), N * frames);
+
+    std::vector<BatchStats> ret;
+    for (size_t threads : thread_counts)
+    {
+        ThreadPool pool(threads);
+        FFTBatch<T> batch(order, NORM_NONE, pool);
+
+        batch.forward(buffer.get(), N, frames); // warm up
+
+        BatchStats total;
+        total.threads = pool.size();
+        for (size_t r = 0; r < repeats; ++r)
+        {
+            batch.forward(buffer.get(), N, frames);
+            total.frames  += batch.stats().frames;
+            total.seconds += batch.stats().seconds;
+        }
+        ret.push_back(total);
+    }
+    return ret;
+}
+
+}
+
+}
@@ -23,6 +23,7 @@ struct IppLinearHelper;
         static constexpr auto mul_implace       = ippsMul_ ## suffix ## _I;  \
         static constexpr auto mul_const         = ippsMulC_ ## suffix;       \
         static constexpr auto mul_const_implace = ippsMulC_ ## suffix ## _I; \
+        static constexpr auto sub               = ippsSub_ ## suffix;        \
         static constexpr auto sub_const         = ippsSubC_ ## suffix;       \
         static constexpr auto sub_const_implace = ippsSubC_ ## suffix ## _I; \
     };
@@ -55,6 +56,23 @@ MAKE_HELPER_INTS(Ipp16sc, 16sc)
 #undef MAKE_HELPER_INTS
 #undef MAKE_HELPER
 
+
+// complex by real multiplication
+template<class T>
+struct IppRealComplexHelper;
+
+#define MAKE_HELPER(type_name, suffix) template<>                      \
+    struct IppRealComplexHelper<type_name>                             \
+    {                                                                  \
+        static constexpr auto mul         = ippsMul_ ## suffix;        \
+        static constexpr auto mul_implace = ippsMul_ ## suffix ## _I;  \
+    };
+
+MAKE_HELPER(Ipp32fc, 32f32fc)
+MAKE_HELPER(Ipp64fc, 64f64fc)
+
+#undef MAKE_HELPER
+
 template<class T>
 inline void copy(const T* from, T* to, std::size_t len)
 {
@@ -85,6 +103,18 @@ inline void mul(const T* src, T* srcDst,  std::size_t len)
     IppLinearHelper<T>::mul_implace(src, srcDst, len);
 }
 
+template<class T>
+inline void mul_by_real(const BaseType<T>* real, const T* src, T* dst, std::size_t len)
+{
+    IppRealComplexHelper<T>::mul(real, src, dst, len);
+}
+
+template<class T>
+inline void mul_by_real(const BaseType<T>* real, T* srcDst, std::size_t len)
+{
+    IppRealComplexHelper<T>::mul_implace(real, srcDst, len);
+}
+
 template<class T>
 inline void mul_const(T value, const T* src, T* dst, std::size_t len)
 {
@@ -122,6 +152,13 @@ inline void add_const(T value, T* srcDst, std::size_t len)
 }
 
 
+// dst = src - sub
+template<class T>
+inline void sub(const T* sub, const T* src, T* dst, std::size_t len)
+{
+    IppLinearHelper<T>::sub(sub, src, dst, len);
+}
+
 template<class T>
 inline void sub_const(T value, const T* src, T* dst, std::size_t len)
 {
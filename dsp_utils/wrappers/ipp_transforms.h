@@ -57,7 +57,7 @@ inline void conj(T* srcDst, std::size_t len)
 template<class T>
 struct IppRealTransformsHelper;
 
-#define MAKE_HELPER(type_name, suffix, prec) template<>                                        \
+#define MAKE_HELPER(type_name, suffix, prec, exp_prec) template<>                              \
     struct IppRealTransformsHelper<type_name>                                                  \
     {                                                                                          \
         static constexpr auto real_to_complex             = ippsRealToCplx_ ## suffix;         \
@@ -66,10 +66,11 @@ struct IppRealTransformsHelper;
         static constexpr auto threshold_less_than         = ippsThreshold_LT_ ## suffix;       \
         static constexpr auto threshold_less_than_implace = ippsThreshold_LT_ ## suffix ## _I; \
         static constexpr auto log10                       = ippsLog10_ ## suffix ## _ ## prec; \
+        static constexpr auto exp                         = ippsExp_ ## suffix ## _ ## exp_prec; \
     };
 
-MAKE_HELPER(Ipp32f, 32f, A24)
-MAKE_HELPER(Ipp64f, 64f, A26)
+MAKE_HELPER(Ipp32f, 32f, A24, A24)
+MAKE_HELPER(Ipp64f, 64f, A26, A53)
 
 #undef MAKE_HELPER
 
@@ -115,5 +116,18 @@ inline void log10(T* srcDst, std::size_t len)
 {
     IppRealTransformsHelper<T>::log10(srcDst, srcDst, len);
 }
+
+// full precision for Ipp64f (A53)
+template<class T>
+inline void exp(const T* src, T* dst, std::size_t len)
+{
+    IppRealTransformsHelper<T>::exp(src, dst, len);
+}
+
+template<class T>
+inline void exp(T* srcDst, std::size_t len)
+{
+    IppRealTransformsHelper<T>::exp(srcDst, srcDst, len);
+}
 }
 }
@@ -0,0 +1,79 @@
+#ifndef COMPLEX_GAUSSIAN_H
+#define COMPLEX_GAUSSIAN_H
+
+#pragma once
+
+#include "gaussian.h"
+
+#include <cmath>
+#include <complex>
+
+namespace statistics
+{
+
+// Circular complex gaussian (IQ samples):
+// p(x) = alpha / (pi * variance) * exp(-|x - mean|^2 / variance),  variance = E|x - mean|^2
+template <class U>
+class Gaussian<std::complex<U>> {
+
+public:
+    using value_type = std::complex<U>;
+
+    Gaussian(const value_type& mean = value_type(0), double variance = 1, double alpha = 1):
+        mean_(mean), variance_(variance), alpha_(alpha)
+    {
+        update_constants();
+    }
+
+    double proba(const value_type& val) const {
+        return std::exp(log_proba(val));
+    }
+
+    double log_proba(const value_type& val) const {
+        return log_norm_ - std::norm(val - mean_) * inv_var_;
+    }
+
+    void proba(const value_type* in, double* out, size_t n, ExpMode mode = ExpMode::Exact) const {
+        log_proba(in, out, n);
+        exp_inplace(out, n, mode);
+    }
+
+    void log_proba(const value_type* in, double* out, size_t n) const {
+        const double mr = mean_.real(), mi = mean_.imag(), c = log_norm_, a = inv_var_;
+        for (size_t i = 0; i < n; ++i){
+            double dr = in[i].real() - mr;
+            double di = in[i].imag() - mi;
+            out[i] = c - (dr * dr + di * di) * a;
+        }
+    }
+
+    inline value_type& mean() { return mean_; }
+    inline value_type mean() const {return mean_;}
+
+    inline void variance(double variance) { variance_ = variance; update_constants(); }
+    inline double variance() const {return variance_;}
+
+    inline void alpha(double alpha) { alpha_ = alpha; update_constants(); }
+    inline double alpha() const {return alpha_;}
+
+    // log(alpha / (pi variance)) and 1 / variance, recomputed by the setters
+    inline double log_norm() const { return log_norm_; }
+    inline double inv_var() const { return inv_var_; }
+
+private:
+    void update_constants(){
+        log_norm_ = std::log(alpha_) - std::log(M_PI * variance_);
+        inv_var_ = 1. / variance_;
+    }
+
+    value_type mean_;
+    double variance_;
+    double alpha_;
+
+    double log_norm_ = 0;
+    double inv_var_ = 0;
+};
+
+}
+
+#endif // COMPLEX_GAUSSIAN_H
@@ -1,6 +1,8 @@
 #ifndef GAUSSIAN_H
 #define GAUSSIAN_H
 
+#include "fast_exp.h"
+
 #include <type_traits>
 #include <utility>
 #include <algorithm>
@@ -15,28 +17,60 @@ class Gaussian {
 public:
     Gaussian(const T& mean = T(0), double variance = 1, double alpha = 1):
         mean_(mean), variance_(variance), alpha_(alpha)
-    {}
+    {
+        update_constants();
+    }
 
     double proba(const T& val) const {
-        auto dx = std::abs(val - mean_);
-        dx *= dx;
-        return std::exp(-dx / variance_ / 2) / sqrt(2 * M_PI * variance_) * alpha_;
+        double dx = std::abs(val - mean_);
+        return std::exp(log_norm_ - dx * dx * inv2var_);
+    }
+
+    double log_proba(const T& val) const {
+        double dx = std::abs(val - mean_);
+        return log_norm_ - dx * dx * inv2var_;
+    }
+
+    void proba(const T* in, double* out, size_t n, ExpMode mode = ExpMode::Exact) const {
+        log_proba(in, out, n);
+        exp_inplace(out, n, mode);
+    }
+
+    void log_proba(const T* in, double* out, size_t n) const {
+        const double m = static_cast<double>(mean_), c = log_norm_, a = inv2var_;
+        for (size_t i = 0; i < n; ++i){
+            double d = in[i] - m;
+            out[i] = c - d * d * a;
+        }
     }
 
     inline T& mean() { return mean_; }
     inline T mean() const {return mean_;}
 
-    inline double& variance() { return variance_; }
+    inline void variance(double variance) { variance_ = variance; update_constants(); }
     inline double variance() const {return variance_;}
 
-    inline double& alpha() {return alpha_;}
+    inline void alpha(double alpha) { alpha_ = alpha; update_constants(); }
     inline double alpha() const {return alpha_;}
 
+    // log(alpha / sqrt(2 pi variance)) and 1 / (2 variance), recomputed by the setters:
+    // const methods only read, so one object can be scored from several threads
+    inline double log_norm() const { return log_norm_; }
+    inline double inv_2var() const { return inv2var_; }
+
 
 private:
+    void update_constants(){
+        log_norm_ = std::log(alpha_) - 0.5 * std::log(2 * M_PI * variance_);
+        inv2var_ = 0.5 / variance_;
+    }
+
     std::enable_if_t<std::is_arithmetic_v<T>, T> mean_;
     double variance_;
     double alpha_;
+
+    double log_norm_ = 0;
+    double inv2var_ = 0;
 };
 
 }
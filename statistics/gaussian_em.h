@@ -0,0 +1,437 @@
+#ifndef GAUSSIAN_EM_H
+#define GAUSSIAN_EM_H
+
+#pragma once
+
+#include "gaussian.h"
+#include "complex_gaussian.h"
+#include "multivariate_gaussian.h"
+#include "../dsp_utils/thread_pool.h"
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+namespace statistics {
+
+// Weighted sufficient statistics of one EM iteration: stride() values per component.
+// Layout is defined by GaussianModel<T>; first value is always sum of responsibilities,
+// first and second order sums are taken around component mean of previous iteration
+struct GaussianEMStats {
+    GaussianEMStats(size_t components = 0, size_t stride = 0):
+        values(components * stride, 0), stride_(stride)
+    {}
+
+    void merge(const GaussianEMStats& other){
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] += other.values[i];
+        weight += other.weight;
+        log_likelihood += other.log_likelihood;
+    }
+
+    inline double* component(size_t k) { return values.data() + k * stride_; }
+    inline const double* component(size_t k) const { return values.data() + k * stride_; }
+    inline double n(size_t k) const { return component(k)[0]; }
+    inline size_t stride() const { return stride_; }
+
+    std::vector<double> values;
+    double weight = 0;
+    double log_likelihood = 0;
+
+private:
+    size_t stride_;
+};
+
+
+// Per sample type pieces of EM:
+//   Component                         -- constants of one component, SoA friendly
+//   prepare(gaussian, min_variance)   -- Component from gaussian
+//   log_density(c, x, out, n)         -- log(alpha * p(x)) for n samples
+//   accumulate(c, x, r, n, stats)     -- add responsibilities r of n samples to stats
+//   maximize(gaussian, c, stats, total_weight, min_variance)
+//   blend(gaussian, c, stats, total_weight, rate, min_variance) -- stepwise (online) update
+template <class T, class Enable = void>
+struct GaussianModel;
+
+
+// real scalar: stats = [n, sum(d), sum(d^2)]
+template <class T>
+struct GaussianModel<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+    struct Component {
+        double mean;
+        double inv2var;
+        double logc; // log(alpha) - log(sqrt(2 pi var))
+    };
+
+    static constexpr size_t stride = 3;
+
+    static Component prepare(const Gaussian<T>& g, double min_variance){
+        double var = std::max(g.variance(), min_variance);
+        return {static_cast<double>(g.mean()), 0.5 / var, std::log(g.alpha()) - 0.5 * std::log(2 * M_PI * var)};
+    }
+
+    static void log_density(const Component& c, const T* x, double* out, size_t n){
+        for (size_t i = 0; i < n; ++i){
+            double d = x[i] - c.mean;
+            out[i] = c.logc - d * d * c.inv2var;
+        }
+    }
+
+    static void accumulate(const Component& c, const T* x, const double* r, size_t n, double* stats){
+        double n0 = 0, n1 = 0, n2 = 0;
+        for (size_t i = 0; i < n; ++i){
+            double d = x[i] - c.mean;
+            n0 += r[i];
+            n1 += r[i] * d;
+            n2 += r[i] * d * d;
+        }
+        stats[0] += n0;
+        stats[1] += n1;
+        stats[2] += n2;
+    }
+
+    static void maximize(Gaussian<T>& g, const Component& c, const double* s, double weight, double min_variance){
+        double N = s[0];
+        double delta = s[1] / N;
+        g.alpha(N / weight);
+        g.mean() = static_cast<T>(c.mean + delta);
+        g.variance(std::max(s[2] / N - delta * delta, min_variance));
+    }
+
+    static void blend(Gaussian<T>& g, const Component& c, const double* s, double weight, double rate,
+                      double min_variance){
+        double N = s[0];
+        double a = (1 - rate) * g.alpha();
+        double b = rate * N / weight;
+        if (!(a + b > 0))
+            return;
+
+        double mean_b = c.mean, var_b = g.variance();
+        if (N > 0){
+            double delta = s[1] / N;
+            mean_b = c.mean + delta;
+            var_b = std::max(s[2] / N - delta * delta, 0.);
+        }
+
+        double w = a + b;
+        double d = mean_b - c.mean;
+        g.variance(std::max((a * g.variance() + b * var_b) / w + a * b * d * d / (w * w), min_variance));
+        g.mean() = static_cast<T>((a * c.mean + b * mean_b) / w);
+        g.alpha(w);
+    }
+};
+
+
+// circular complex: stats = [n, sum(re d), sum(im d), sum(|d|^2)]
+template <class U>
+struct GaussianModel<std::complex<U>> {
+    using value_type = std::complex<U>;
+
+    struct Component {
+        double mean_re;
+        double mean_im;
+        double inv_var;
+        double logc; // log(alpha) - log(pi var)
+    };
+
+    static constexpr size_t stride = 4;
+
+    static Component prepare(const Gaussian<value_type>& g, double min_variance){
+        double var = std::max(g.variance(), min_variance);
+        return {static_cast<double>(g.mean().real()), static_cast<double>(g.mean().imag()),
+                1. / var, std::log(g.alpha()) - std::log(M_PI * var)};
+    }
+
+    static void log_density(const Component& c, const value_type* x, double* out, size_t n){
+        for (size_t i = 0; i < n; ++i){
+            double dr = x[i].real() - c.mean_re;
+            double di = x[i].imag() - c.mean_im;
+            out[i] = c.logc - (dr * dr + di * di) * c.inv_var;
+        }
+    }
+
+    static void accumulate(const Component& c, const value_type* x, const double* r, size_t n, double* stats){
+        double n0 = 0, nr = 0, ni = 0, n2 = 0;
+        for (size_t i = 0; i < n; ++i){
+            double dr = x[i].real() - c.mean_re;
+            double di = x[i].imag() - c.mean_im;
+            n0 += r[i];
+            nr += r[i] * dr;
+            ni += r[i] * di;
+            n2 += r[i] * (dr * dr + di * di);
+        }
+        stats[0] += n0;
+        stats[1] += nr;
+        stats[2] += ni;
+        stats[3] += n2;
+    }
+
+    static void maximize(Gaussian<value_type>& g, const Component& c, const double* s, double weight,
+                         double min_variance){
+        double N = s[0];
+        double dr = s[1] / N, di = s[2] / N;
+        g.alpha(N / weight);
+        g.mean() = value_type(static_cast<U>(c.mean_re + dr), static_cast<U>(c.mean_im + di));
+        g.variance(std::max(s[3] / N - dr * dr - di * di, min_variance));
+    }
+
+    static void blend(Gaussian<value_type>& g, const Component& c, const double* s, double weight, double rate,
+                      double min_variance){
+        double N = s[0];
+        double a = (1 - rate) * g.alpha();
+        double b = rate * N / weight;
+        if (!(a + b > 0))
+            return;
+
+        double dr = 0, di = 0, var_b = g.variance();
+        if (N > 0){
+            dr = s[1] / N;
+            di = s[2] / N;
+            var_b = std::max(s[3] / N - dr * dr - di * di, 0.);
+        }
+
+        double w = a + b;
+        g.variance(std::max((a * g.variance() + b * var_b) / w + a * b * (dr * dr + di * di) / (w * w),
+                            min_variance));
+        g.mean() = value_type(static_cast<U>(c.mean_re + b * dr / w), static_cast<U>(c.mean_im + b * di / w));
+        g.alpha(w);
+    }
+};
+
+
+// D-dimensional, full covariance: stats = [n, sum(d) (D), sum(d d^T) (D x D)]
+template <class U, size_t D>
+struct GaussianModel<std::array<U, D>> {
+    using value_type = std::array<U, D>;
+    using GaussianT = Gaussian<value_type>;
+
+    // own copy with floored diagonal, factorized once here, read-only in worker threads
+    struct Component {
+        GaussianT gaussian;
+        std::array<double, D> mean;
+    };
+
+    static constexpr size_t stride = 1 + D + D * D;
+
+    static Component prepare(const GaussianT& g, double min_variance){
+        auto cov = g.covariance();
+        for (size_t j = 0; j < D; ++j)
+            cov[j * D + j] = std::max(cov[j * D + j], min_variance);
+
+        Component c{GaussianT(g.mean(), cov, g.alpha()), {}};
+        for (size_t j = 0; j < D; ++j)
+            c.mean[j] = g.mean()[j];
+        return c;
+    }
+
+    static void log_density(const Component& c, const value_type* x, double* out, size_t n){
+        c.gaussian.log_proba(x, out, n);
+    }
+
+    static void accumulate(const Component& c, const value_type* x, const double* r, size_t n, double* stats){
+        double* s1 = stats + 1;
+        double* s2 = stats + 1 + D;
+        for (size_t i = 0; i < n; ++i){
+            std::array<double, D> d;
+            for (size_t j = 0; j < D; ++j)
+                d[j] = x[i][j] - c.mean[j];
+
+            stats[0] += r[i];
+            for (size_t j = 0; j < D; ++j){
+                double rd = r[i] * d[j];
+                s1[j] += rd;
+                for (size_t l = 0; l < D; ++l)
+                    s2[j * D + l] += rd * d[l];
+            }
+        }
+    }
+
+    static void maximize(GaussianT& g, const Component& c, const double* s, double weight, double min_variance){
+        double N = s[0];
+        std::array<double, D> delta;
+        for (size_t j = 0; j < D; ++j)
+            delta[j] = s[1 + j] / N;
+
+        typename GaussianT::matrix_type cov;
+        for (size_t j = 0; j < D; ++j){
+            g.mean()[j] = static_cast<U>(c.mean[j] + delta[j]);
+            for (size_t l = 0; l < D; ++l)
+                cov[j * D + l] = s[1 + D + j * D + l] / N - delta[j] * delta[l];
+            cov[j * D + j] = std::max(cov[j * D + j], min_variance);
+        }
+        g.alpha(N / weight);
+        g.covariance(cov);
+    }
+
+    static void blend(GaussianT& g, const Component& c, const double* s, double weight, double rate,
+                      double min_variance){
+        double N = s[0];
+        double a = (1 - rate) * g.alpha();
+        double b = rate * N / weight;
+        if (!(a + b > 0))
+            return;
+
+        double w = a + b;
+        std::array<double, D> delta{};
+        if (N > 0){
+            for (size_t j = 0; j < D; ++j)
+                delta[j] = s[1 + j] / N;
+        }
+
+        auto cov = g.covariance();
+        for (size_t j = 0; j < D; ++j){
+            for (size_t l = 0; l < D; ++l){
+                double cov_a = cov[j * D + l];
+                double cov_b = N > 0 ? s[1 + D + j * D + l] / N - delta[j] * delta[l] : cov_a;
+                cov[j * D + l] = (a * cov_a + b * cov_b) / w + a * b * delta[j] * delta[l] / (w * w);
+            }
+            cov[j * D + j] = std::max(cov[j * D + j], min_variance);
+        }
+        for (size_t j = 0; j < D; ++j)
+            g.mean()[j] = static_cast<U>(c.mean[j] + b * delta[j] / w);
+        g.alpha(w);
+        g.covariance(cov);
+    }
+};
+
+
+// EM step in structure-of-arrays form, sample type agnostic (see GaussianModel).
+// Per-component constants are computed once per iteration, responsibilities are
+// evaluated in log domain block by block and immediately folded into sufficient
+// statistics, so E and M steps share one pass over the data.
+// Sample range is split between threads, partial statistics are summed.
+// exp_mode picks std::exp or the table-driven FastExp for responsibilities
+template <class T>
+class GaussianEM {
+public:
+    using Model = GaussianModel<T>;
+
+    static constexpr size_t block_size = 256;
+    static constexpr size_t parallel_threshold = 1 << 16;
+
+    explicit GaussianEM(const std::vector<Gaussian<T>>& gaussians, double min_variance = 1e-12,
+                        ExpMode exp_mode = ExpMode::Exact):
+        min_variance_(min_variance), exp_mode_(exp_mode)
+    {
+        for (auto& g : gaussians)
+            components_.push_back(Model::prepare(g, min_variance_));
+    }
+
+    inline size_t components() const { return components_.size(); }
+
+    // w == nullptr: every sample has weight 1
+    template <class W>
+    void accumulate(const T* x, const W* w, size_t count, GaussianEMStats& stats) const {
+        const size_t K = components();
+        const size_t B = block_size;
+
+        thread_local std::vector<double> scratch;
+        scratch.resize((K + 3) * B);
+
+        double* lp  = scratch.data();         // K x B log densities -> densities -> responsibilities
+        double* mx  = lp + K * B;
+        double* sum = mx + B;
+        double* f   = sum + B;
+
+        for (size_t start = 0; start < count; start += B){
+            const size_t n = std::min(B, count - start);
+            const T* xb = x + start;
+
+            for (size_t k = 0; k < K; ++k)
+                Model::log_density(components_[k], xb, lp + k * B, n);
+
+            std::fill(mx, mx + n, -std::numeric_limits<double>::infinity());
+            for (size_t k = 0; k < K; ++k){
+                const double* row = lp + k * B;
+                for (size_t i = 0; i < n; ++i)
+                    mx[i] = std::max(mx[i], row[i]);
+            }
+
+            // shift, exp over the whole row, then sum: exp runs as one batch kernel per row
+            std::fill(sum, sum + n, 0.);
+            for (size_t k = 0; k < K; ++k){
+                double* row = lp + k * B;
+                for (size_t i = 0; i < n; ++i)
+                    row[i] -= mx[i];
+                exp_inplace(row, n, exp_mode_);
+                for (size_t i = 0; i < n; ++i)
+                    sum[i] += row[i];
+            }
+
+            double ll = 0, wsum = 0;
+            for (size_t i = 0; i < n; ++i){
+                double wi = w ? static_cast<double>(w[start + i]) : 1.;
+                f[i] = wi / sum[i];
+                ll += wi * (mx[i] + std::log(sum[i]));
+                wsum += wi;
+            }
+            stats.log_likelihood += ll;
+            stats.weight += wsum;
+
+            for (size_t k = 0; k < K; ++k){
+                double* row = lp + k * B;
+                for (size_t i = 0; i < n; ++i)
+                    row[i] *= f[i];
+                Model::accumulate(components_[k], xb, row, n, stats.component(k));
+            }
+        }
+    }
+
+    // E step over whole data, threaded for big inputs
+    template <class W>
+    GaussianEMStats expectation(const T* x, const W* w, size_t count,
+                                dsp_utils::ThreadPool& pool = dsp_utils::ThreadPool::global()) const {
+        if (count < parallel_threshold || pool.size() < 2){
+            GaussianEMStats stats(components(), Model::stride);
+            accumulate(x, w, count, stats);
+            return stats;
+        }
+
+        std::vector<GaussianEMStats> partial(pool.size(), GaussianEMStats(components(), Model::stride));
+        size_t grain = std::max<size_t>(count / (4 * pool.size()), block_size);
+
+        dsp_utils::parallel_for(pool, count, grain, [&](size_t begin, size_t end, size_t worker){
+            accumulate(x + begin, w ? w + begin : w, end - begin, partial[worker]);
+        });
+
+        for (size_t i = 1; i < partial.size(); ++i)
+            partial.front().merge(partial[i]);
+        return partial.front();
+    }
+
+    // M step: new parameters from statistics.
+    // Component without responsibility gets alpha 0, so weights still sum to 1
+    void maximization(std::vector<Gaussian<T>>& gaussians, const GaussianEMStats& stats) const {
+        for (size_t k = 0; k < gaussians.size(); ++k){
+            if (!(stats.n(k) > 0)){
+                gaussians[k].alpha(0);
+                continue;
+            }
+            Model::maximize(gaussians[k], components_[k], stats.component(k), stats.weight, min_variance_);
+        }
+    }
+
+    // stepwise (online) M step: parameters are blended with chunk estimates,
+    // old ones have weight (1 - rate), chunk ones -- rate.
+    // alpha / mean / variance are exactly moments of the blended statistics,
+    // so the state is just gaussians themselves
+    void blend(std::vector<Gaussian<T>>& gaussians, const GaussianEMStats& stats, double rate) const {
+        if (!(stats.weight > 0))
+            return;
+        rate = std::min(std::max(rate, 0.), 1.);
+
+        for (size_t k = 0; k < gaussians.size(); ++k)
+            Model::blend(gaussians[k], components_[k], stats.component(k), stats.weight, rate, min_variance_);
+    }
+
+private:
+    double min_variance_;
+    ExpMode exp_mode_;
+    std::vector<typename Model::Component> components_;
+};
+
+}
+
+#endif // GAUSSIAN_EM_H
@@ -4,12 +4,30 @@
 #pragma once
 
 #include "gaussian.h"
+#include "gaussian_em.h"
+#include "kmeans.h"
 #include <vector>
 #include <numeric>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <cmath>
 
 
 namespace statistics{
 
+// step size of stepwise EM: (step + offset)^(-kappa), kappa in (0.5, 1]
+inline double stepwise_rate(size_t step, double kappa = 0.6, double offset = 2){
+    return std::pow(step + offset, -kappa);
+}
+
+struct EMResult {
+    size_t iterations = 0;
+    double log_likelihood = 0;
+    bool converged = false;
+};
+
+
 template <class T>
 class GaussianMixture
 {
@@ -19,6 +37,15 @@ public:
         normalize();
     }
 
+    // initial components from k-means++ / Lloyd over data
+    GaussianMixture(const T* data, size_t n, size_t components, const KMeansConfig& config = {}):
+        GaussianMixture(kmeans_init(data, n, components, config))
+    {}
+
+    GaussianMixture(const std::vector<T>& data, size_t components, const KMeansConfig& config = {}):
+        GaussianMixture(data.data(), data.size(), components, config)
+    {}
+
     double proba(const T& val) const {
         double p = 0;
         for (auto& g : gaussians_)
@@ -26,6 +53,14 @@ public:
         return p;
     }
 
+    void proba(const T* in, double* out, size_t n, ExpMode mode = ExpMode::Exact) const {
+        evaluate(in, out, n, mode, false);
+    }
+
+    void log_proba(const T* in, double* out, size_t n, ExpMode mode = ExpMode::Exact) const {
+        evaluate(in, out, n, mode, true);
+    }
+
     void clear(){
         gaussians_.clear();
     }
@@ -38,6 +73,10 @@ public:
         return gaussians_.at(i);
     }
 
+    size_t size() const {
+        return gaussians_.size();
+    }
+
 
     void normalize(){
         double sum = 0;
@@ -45,69 +84,166 @@ public:
             sum += g.alpha();
 
         for (auto& g : gaussians_)
-            g.alpha() /= sum;
+            g.alpha(g.alpha() / sum);
+    }
+
+    // EM until log-likelihood per unit of weight changes less than tolerance
+    EMResult fit(const T* val, size_t n, size_t max_iterations = 100, double tolerance = 1e-7){
+        return fit_internal(val, static_cast<const uint32_t*>(nullptr), n, max_iterations, tolerance);
+    }
+
+    EMResult fit(const std::vector<T>& val, size_t max_iterations = 100, double tolerance = 1e-7){
+        return fit(val.data(), val.size(), max_iterations, tolerance);
+    }
+
+    template<class cntType>
+    EMResult fit(const T* val, const cntType* cnt, size_t n, size_t max_iterations = 100, double tolerance = 1e-7){
+        return fit_internal(val, cnt, n, max_iterations, tolerance);
     }
 
     template<class cntType>
-    void recalc(const std::vector<T>& val, const std::vector<cntType>& cnt){
-        recalc_internal(val, cnt);
+    EMResult fit(const std::vector<T>& val, const std::vector<cntType>& cnt,
+                 size_t max_iterations = 100, double tolerance = 1e-7){
+        if (val.size() != cnt.size()){
+            throw std::range_error("cnt.size() != val.size()");
+        }
+        return fit(val.data(), cnt.data(), val.size(), max_iterations, tolerance);
     }
-    void recalc(const std::vector<T>& val)
+
+    // one EM iteration, returns log-likelihood of data under previous parameters
+    template<class cntType>
+    double recalc(const std::vector<T>& val, const std::vector<cntType>& cnt){
+        if (val.size() != cnt.size()){
+            throw std::range_error("cnt.size() != val.size()");
+        }
+        return recalc_internal(val.data(), cnt.data(), val.size());
+    }
+    double recalc(const std::vector<T>& val)
     {
-        recalc_internal(val, std::vector<uint32_t>(val.size(), 1));
+        return recalc(val.data(), val.size());
     }
 
+    template<class cntType>
+    double recalc(const T* val, const cntType* cnt, size_t n){
+        return recalc_internal(val, cnt, n);
+    }
+    double recalc(const T* val, size_t n){
+        return recalc_internal(val, static_cast<const uint32_t*>(nullptr), n);
+    }
 
+    // Online EM: one stepwise update from a chunk of stream, O(components) memory.
+    // rate in (0, 1] is the forgetting factor: weight of chunk statistics against
+    // the current model, see stepwise_rate() for a decaying schedule.
+    // Returns log-likelihood of the chunk under previous parameters
+    double update(const T* val, size_t n, double rate){
+        return update_internal(val, static_cast<const uint32_t*>(nullptr), n, rate);
+    }
 
-private:
+    double update(const std::vector<T>& val, double rate){
+        return update(val.data(), val.size(), rate);
+    }
 
     template<class cntType>
-    void recalc_internal(const std::vector<T>& val, const std::vector<cntType>& cnt){
+    double update(const std::vector<T>& val, const std::vector<cntType>& cnt, double rate){
         static_assert (std::is_integral_v<cntType>, "values counts must be integers!");
-
         if (val.size() != cnt.size()){
             throw std::range_error("cnt.size() != val.size()");
         }
+        return update_internal(val.data(), cnt.data(), val.size(), rate);
+    }
 
-        std::vector<double> vproba(val.size());
-        std::transform(begin(val), end(val), begin(vproba),
-                       [this](auto x){return proba(x);});
 
 
-        std::vector<std::vector<double>> W;
-        std::vector<double> Ng;
+private:
 
-        for (auto&& g : gaussians_){
-            W.push_back({});
-            double sum = 0;
-            auto& Wline = W.back();
-            for (size_t i = 0; i < val.size(); ++i)
-            {
-                Wline.emplace_back( cnt[i] * g.proba(val[i]) / vproba[i]  );
-                sum += Wline.back();
+    template<class cntType>
+    EMResult fit_internal(const T* val, const cntType* cnt, size_t n, size_t max_iterations, double tolerance){
+        double weight = n;
+        if (cnt){
+            weight = 0;
+            for (size_t i = 0; i < n; ++i)
+                weight += cnt[i];
+        }
+
+        EMResult result;
+        double prev = -std::numeric_limits<double>::infinity();
+        for (size_t it = 0; it < max_iterations; ++it){
+            result.log_likelihood = recalc_internal(val, cnt, n);
+            result.iterations = it + 1;
+            if (std::abs(result.log_likelihood - prev) <= tolerance * weight){
+                result.converged = true;
+                break;
             }
-            Ng.emplace_back(sum);
+            prev = result.log_likelihood;
         }
+        return result;
+    }
 
-        cntType N = std::accumulate(begin(cnt), end(cnt), cntType(0));
+    template<class cntType>
+    double update_internal(const T* val, const cntType* cnt, size_t n, double rate){
+        GaussianEM<T> em(gaussians_);
+        auto stats = em.expectation(val, cnt, n);
+        em.blend(gaussians_, stats, rate);
+        normalize();
 
-        for (size_t i = 0; i < gaussians_.size(); ++i){
-            gaussians_[i].alpha() = Ng[i] / N;
+        return stats.log_likelihood;
+    }
 
-            T mean = std::inner_product(begin(W[i]), end(W[i]), begin(val), T(0)) / Ng[i];
-            gaussians_[i].mean() = mean;
+    template<class cntType>
+    double recalc_internal(const T* val, const cntType* cnt, size_t n){
+        static_assert (std::is_integral_v<cntType>, "values counts must be integers!");
 
+        GaussianEM<T> em(gaussians_);
+        auto stats = em.expectation(val, cnt, n);
+        em.maximization(gaussians_, stats);
 
+        return stats.log_likelihood;
+    }
 
-            gaussians_[i].variance() = std::inner_product(
-                        begin(W[i]), end(W[i]), begin(val), 0.,
-                        std::plus<double>(),
-                        [mean](double w, const T& x)->double{
-                               auto AX = std::abs<T>(x - mean);
-                               return w * AX * AX;
-                        }) / Ng[i];
-        }
 
+    // components x block of log densities, then log-sum-exp over components
+    void evaluate(const T* in, double* out, size_t n, ExpMode mode, bool log_domain) const {
+        constexpr size_t B = 256;
+        const size_t K = gaussians_.size();
+
+        thread_local std::vector<double> scratch;
+        scratch.resize((K + 1) * B);
+        double* lp = scratch.data();
+        double* mx = lp + K * B;
+
+        for (size_t start = 0; start < n; start += B){
+            const size_t len = std::min(B, n - start);
+            double* dst = out + start;
+
+            for (size_t k = 0; k < K; ++k)
+                gaussians_[k].log_proba(in + start, lp + k * B, len);
+
+            std::fill(mx, mx + len, -std::numeric_limits<double>::infinity());
+            for (size_t k = 0; k < K; ++k){
+                const double* row = lp + k * B;
+                for (size_t i = 0; i < len; ++i)
+                    mx[i] = std::max(mx[i], row[i]);
+            }
+
+            std::fill(dst, dst + len, 0.);
+            for (size_t k = 0; k < K; ++k){
+                double* row = lp + k * B;
+                for (size_t i = 0; i < len; ++i)
+                    row[i] -= std::isfinite(mx[i]) ? mx[i] : 0;
+                exp_inplace(row, len, mode);
+                for (size_t i = 0; i < len; ++i)
+                    dst[i] += row[i];
+            }
+
+            if (log_domain){
+                for (size_t i = 0; i < len; ++i)
+                    dst[i] = std::log(dst[i]) + (std::isfinite(mx[i]) ? mx[i] : 0);
+            } else {
+                exp_inplace(mx, len, mode);
+                for (size_t i = 0; i < len; ++i)
+                    dst[i] *= mx[i];
+            }
+        }
     }
 
 
@@ -0,0 +1,151 @@
+#ifndef HISTOGRAM_FIT_H
+#define HISTOGRAM_FIT_H
+
+#pragma once
+
+#include "gaussian_mixture.h"
+
+#include "../dsp_utils/histogram.h"
+#include "../dsp_utils/moments.h"
+#include "../dsp_utils/thread_pool.h"
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+
+namespace statistics {
+
+struct HistogramFitConfig {
+    // 0: adaptive, bin width = resolution * stddev of data
+    size_t bins = 0;
+    double resolution = 0.01;
+    size_t min_bins = 64;
+    size_t max_bins = 1 << 20;
+
+    size_t max_iterations = 200;
+    // stop when log-likelihood per sample changes less than tolerance
+    double tolerance = 1e-9;
+
+    // EM iterations on raw data after histogram fit
+    size_t refine_iterations = 0;
+};
+
+struct HistogramFitReport {
+    uint64_t samples = 0;
+    size_t bins = 0;
+    size_t occupied_bins = 0;
+    double bin_width = 0;
+
+    size_t iterations = 0;
+    size_t refine_iterations = 0;
+    // histogram fit: of bin centers weighted by counts; refined: of raw data under
+    // parameters before the last refine iteration (as returned by recalc)
+    double log_likelihood = 0;
+
+    // Filled by the refine pass, measured on raw data (no a priori bound on binning error).
+    // Raw-data log-likelihood under histogram fit parameters
+    double binned_log_likelihood = 0;
+    // log_likelihood - binned_log_likelihood; EM does not decrease likelihood, so the final
+    // parameters gain at least this much
+    double refine_gain = 0;
+    // largest change over components, histogram fit -> refined
+    double max_mean_shift = 0;
+    double max_variance_ratio = 1; // max(v_refined / v_binned, v_binned / v_refined)
+    double max_alpha_shift = 0;
+};
+
+
+// Fits mixture to huge data set: data is binned once (in parallel), EM runs on occupied bin centers
+// weighted by counts, so each iteration costs O(bins) instead of O(samples).
+// Mixture must be initialized, its parameters are used as starting point
+template <class T>
+HistogramFitReport fit_histogram(GaussianMixture<T>& mixture, const T* data, size_t n,
+                                 const HistogramFitConfig& config = {},
+                                 dsp_utils::ThreadPool& pool = dsp_utils::ThreadPool::global())
+{
+    static_assert (std::is_floating_point_v<T>, "only floating point data supported!");
+
+    HistogramFitReport report;
+    report.samples = n;
+    if (n == 0)
+        return report;
+
+    auto m = dsp_utils::moments_parallel(data, n, pool);
+
+    size_t bins = config.bins;
+    if (bins == 0){
+        double width = config.resolution * m.stddev();
+        double range = m.max - m.min;
+        bins = width > 0 ? static_cast<size_t>(std::ceil(range / width)) : 1;
+    }
+    bins = std::min(std::max(bins, config.min_bins), config.max_bins);
+
+    T lo = static_cast<T>(m.min);
+    T hi = static_cast<T>(m.max);
+    if (!(lo < hi)){
+        // constant data: one bin centered on the value
+        T half = static_cast<T>(0.5 * std::max(1., std::abs(m.min)));
+        lo -= half;
+        hi += half;
+        bins = 1;
+    }
+
+    auto hist = dsp_utils::histogram_parallel(data, n, lo, hi, bins, pool);
+
+    std::vector<T> centers;
+    std::vector<uint64_t> counts;
+    for (size_t i = 0; i < hist.bins(); ++i){
+        if (hist.count(i) == 0)
+            continue;
+        centers.push_back(static_cast<T>(hist.bin_center(i)));
+        counts.push_back(hist.count(i));
+    }
+
+    report.bins = hist.bins();
+    report.occupied_bins = centers.size();
+    report.bin_width = hist.bin_width();
+
+    auto em = mixture.fit(centers, counts, config.max_iterations, config.tolerance);
+    report.iterations = em.iterations;
+    report.log_likelihood = em.log_likelihood;
+
+    if (config.refine_iterations == 0)
+        return report;
+
+    std::vector<Gaussian<T>> binned;
+    for (size_t k = 0; k < mixture.size(); ++k)
+        binned.push_back(mixture.get(k));
+
+    for (size_t it = 0; it < config.refine_iterations; ++it){
+        report.log_likelihood = mixture.recalc(data, n);
+        if (it == 0)
+            report.binned_log_likelihood = report.log_likelihood;
+        report.refine_iterations = it + 1;
+    }
+    report.refine_gain = report.log_likelihood - report.binned_log_likelihood;
+
+    for (size_t k = 0; k < binned.size(); ++k){
+        const auto& a = binned[k];
+        const auto& b = mixture.get(k);
+        report.max_mean_shift = std::max(report.max_mean_shift, double(std::abs(b.mean() - a.mean())));
+        report.max_variance_ratio = std::max({report.max_variance_ratio,
+                                              b.variance() / a.variance(), a.variance() / b.variance()});
+        report.max_alpha_shift = std::max(report.max_alpha_shift, std::abs(b.alpha() - a.alpha()));
+    }
+
+    return report;
+}
+
+template <class T>
+HistogramFitReport fit_histogram(GaussianMixture<T>& mixture, const std::vector<T>& data,
+                                 const HistogramFitConfig& config = {},
+                                 dsp_utils::ThreadPool& pool = dsp_utils::ThreadPool::global())
+{
+    return fit_histogram(mixture, data.data(), data.size(), config, pool);
+}
+
+}
+
+#endif // HISTOGRAM_FIT_H
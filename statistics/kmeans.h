@@ -0,0 +1,166 @@
+#ifndef KMEANS_H
+#define KMEANS_H
+
+#pragma once
+
+#include "gaussian.h"
+#include "../dsp_utils/thread_pool.h"
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace statistics {
+
+struct KMeansConfig {
+    size_t lloyd_iterations = 5;
+    uint64_t seed = 0;
+    size_t grain = 1 << 15;
+};
+
+
+// k-means++ seeding + a few Lloyd iterations, both parallel over data.
+// Result is a starting point for EM: alpha = cluster share, mean = centroid,
+// variance = within-cluster variance
+template <class T>
+std::vector<Gaussian<T>> kmeans_init(const T* data, size_t n, size_t k, const KMeansConfig& config = {},
+                                     dsp_utils::ThreadPool& pool = dsp_utils::ThreadPool::global())
+{
+    static_assert (std::is_arithmetic_v<T>, "only real data supported!");
+
+    if (k == 0 || n < k){
+        throw std::range_error("kmeans_init: need at least k samples");
+    }
+
+    const size_t grain = std::max<size_t>(config.grain, 1);
+    const size_t tasks = (n + grain - 1) / grain;
+
+    std::mt19937_64 rng(config.seed);
+    std::vector<double> centers;
+    centers.push_back(static_cast<double>(data[std::uniform_int_distribution<size_t>(0, n - 1)(rng)]));
+
+    // k-means++: next center drawn with probability ~ squared distance to nearest center
+    std::vector<double> dist(n, std::numeric_limits<double>::infinity());
+    std::vector<double> task_sum(tasks);
+    while (centers.size() < k){
+        const double c = centers.back();
+        pool.run(tasks, [&](size_t task, size_t){
+            size_t begin = task * grain, end = std::min(begin + grain, n);
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i){
+                double d = data[i] - c;
+                dist[i] = std::min(dist[i], d * d);
+                sum += dist[i];
+            }
+            task_sum[task] = sum;
+        });
+
+        double total = 0;
+        for (double s : task_sum)
+            total += s;
+
+        size_t pick = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+        if (total > 0){
+            double r = std::uniform_real_distribution<double>(0, total)(rng);
+            size_t task = 0;
+            while (task + 1 < tasks && r >= task_sum[task]){
+                r -= task_sum[task];
+                ++task;
+            }
+            size_t end = std::min(task * grain + grain, n);
+            pick = end - 1;
+            for (size_t i = task * grain; i < end; ++i){
+                if (r < dist[i]){
+                    pick = i;
+                    break;
+                }
+                r -= dist[i];
+            }
+        }
+        centers.push_back(static_cast<double>(data[pick]));
+    }
+
+    // Lloyd iterations; per-worker sums are taken around current centers
+    struct Partial {
+        std::vector<double> n, s1, s2;
+    };
+
+    std::vector<double> cnt(k), s1(k), s2(k);
+    for (size_t it = 0; it <= config.lloyd_iterations; ++it){
+        std::vector<double> sorted(centers);
+        std::sort(begin(sorted), end(sorted));
+        centers = sorted;
+
+        std::vector<Partial> partial(pool.size(), Partial{std::vector<double>(k, 0), std::vector<double>(k, 0), std::vector<double>(k, 0)});
+
+        dsp_utils::parallel_for(pool, n, grain, [&](size_t begin, size_t end, size_t worker){
+            auto& p = partial[worker];
+            for (size_t i = begin; i < end; ++i){
+                double x = data[i];
+                // centers are sorted: nearest one is next to insertion point
+                size_t j = std::lower_bound(centers.begin(), centers.end(), x) - centers.begin();
+                if (j == k || (j > 0 && x - centers[j - 1] < centers[j] - x))
+                    --j;
+                double d = x - centers[j];
+                p.n[j] += 1;
+                p.s1[j] += d;
+                p.s2[j] += d * d;
+            }
+        });
+
+        std::fill(begin(cnt), end(cnt), 0.);
+        std::fill(begin(s1), end(s1), 0.);
+        std::fill(begin(s2), end(s2), 0.);
+        for (auto& p : partial){
+            for (size_t j = 0; j < k; ++j){
+                cnt[j] += p.n[j];
+                s1[j] += p.s1[j];
+                s2[j] += p.s2[j];
+            }
+        }
+
+        if (it == config.lloyd_iterations)
+            break;
+
+        for (size_t j = 0; j < k; ++j){
+            if (cnt[j] > 0)
+                centers[j] += s1[j] / cnt[j];
+        }
+    }
+
+    double total_var = 0;
+    for (size_t j = 0; j < k; ++j)
+        total_var += s2[j];
+    total_var = std::max(total_var / n, std::numeric_limits<double>::min());
+
+    std::vector<Gaussian<T>> ret;
+    for (size_t j = 0; j < k; ++j){
+        double alpha = std::max(cnt[j], 1.) / (n + k);
+        double mean = centers[j];
+        double var = total_var;
+        if (cnt[j] > 1){
+            double delta = s1[j] / cnt[j];
+            mean += delta;
+            var = s2[j] / cnt[j] - delta * delta;
+        }
+        var = std::max(var, total_var * 1e-6);
+        ret.emplace_back(static_cast<T>(mean), var, alpha);
+    }
+    return ret;
+}
+
+template <class T>
+std::vector<Gaussian<T>> kmeans_init(const std::vector<T>& data, size_t k, const KMeansConfig& config = {},
+                                     dsp_utils::ThreadPool& pool = dsp_utils::ThreadPool::global())
+{
+    return kmeans_init(data.data(), data.size(), k, config, pool);
+}
+
+}
+
+#endif // KMEANS_H
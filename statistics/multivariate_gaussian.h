@@ -0,0 +1,162 @@
+#ifndef MULTIVARIATE_GAUSSIAN_H
+#define MULTIVARIATE_GAUSSIAN_H
+
+#pragma once
+
+#include "gaussian.h"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+namespace statistics
+{
+
+template <size_t D>
+using CovarianceMatrix = std::array<double, D * D>; // row-major
+
+template <size_t D>
+inline CovarianceMatrix<D> identity_covariance(double variance = 1){
+    CovarianceMatrix<D> c{};
+    for (size_t i = 0; i < D; ++i)
+        c[i * D + i] = variance;
+    return c;
+}
+
+
+// D-dimensional gaussian with full covariance, samples are std::array<U, D>.
+// Cholesky factor L (covariance = L * L^T) and log-determinant are computed
+// when covariance or alpha are set, const methods only read them
+template <class U, size_t D>
+class Gaussian<std::array<U, D>> {
+
+public:
+    using value_type = std::array<U, D>;
+    using matrix_type = CovarianceMatrix<D>;
+
+    static constexpr size_t dims = D;
+    static constexpr size_t block_size = 256;
+    // squared Cholesky pivots are floored at min_pivot * largest variance
+    static constexpr double min_pivot = 1e-12;
+
+    Gaussian(const value_type& mean = value_type{}, const matrix_type& covariance = identity_covariance<D>(),
+             double alpha = 1):
+        mean_(mean), covariance_(covariance), alpha_(alpha)
+    {
+        factorize();
+    }
+
+    double proba(const value_type& val) const {
+        return std::exp(log_proba(val));
+    }
+
+    double log_proba(const value_type& val) const {
+        double out;
+        log_proba(&val, &out, 1);
+        return out;
+    }
+
+    void proba(const value_type* in, double* out, size_t n, ExpMode mode = ExpMode::Exact) const {
+        log_proba(in, out, n);
+        exp_inplace(out, n, mode);
+    }
+
+    // samples are transposed block by block to coordinate arrays (SoA),
+    // whitening z = L^-1 (x - mean) is forward substitution vectorized over samples
+    void log_proba(const value_type* in, double* out, size_t n) const {
+        thread_local std::vector<double> scratch;
+        scratch.resize(D * block_size);
+
+        for (size_t start = 0; start < n; start += block_size){
+            const size_t len = std::min(block_size, n - start);
+            const value_type* x = in + start;
+            double* dst = out + start;
+
+            std::fill(dst, dst + len, 0.);
+            for (size_t j = 0; j < D; ++j){
+                double* zj = scratch.data() + j * block_size;
+                const double m = mean_[j];
+                for (size_t i = 0; i < len; ++i)
+                    zj[i] = x[i][j] - m;
+
+                for (size_t l = 0; l < j; ++l){
+                    const double c = chol_[j * D + l];
+                    const double* zl = scratch.data() + l * block_size;
+                    for (size_t i = 0; i < len; ++i)
+                        zj[i] -= c * zl[i];
+                }
+
+                const double inv = inv_diag_[j];
+                for (size_t i = 0; i < len; ++i){
+                    zj[i] *= inv;
+                    dst[i] += zj[i] * zj[i];
+                }
+            }
+
+            for (size_t i = 0; i < len; ++i)
+                dst[i] = log_norm_ - 0.5 * dst[i];
+        }
+    }
+
+    inline value_type& mean() { return mean_; }
+    inline const value_type& mean() const {return mean_;}
+
+    inline void covariance(const matrix_type& covariance) { covariance_ = covariance; factorize(); }
+    inline const matrix_type& covariance() const { return covariance_; }
+
+    inline void alpha(double alpha) { alpha_ = alpha; update_norm(); }
+    inline double alpha() const {return alpha_;}
+
+    // log(alpha) - D/2 log(2 pi) - 1/2 log det(covariance)
+    inline double log_norm() const { return log_norm_; }
+    inline double log_det() const { return log_det_; }
+    inline const matrix_type& cholesky() const { return chol_; }
+
+private:
+    // Cholesky, pivots below the relative floor are clamped to keep factor usable
+    void factorize(){
+        double max_var = 0;
+        for (size_t j = 0; j < D; ++j)
+            max_var = std::max(max_var, covariance_[j * D + j]);
+        const double floor = std::max(min_pivot * max_var, std::numeric_limits<double>::min());
+
+        chol_.fill(0);
+        log_det_ = 0;
+        for (size_t j = 0; j < D; ++j){
+            double d = covariance_[j * D + j];
+            for (size_t k = 0; k < j; ++k)
+                d -= chol_[j * D + k] * chol_[j * D + k];
+            d = std::sqrt(std::max(d, floor));
+            chol_[j * D + j] = d;
+            inv_diag_[j] = 1. / d;
+            log_det_ += 2 * std::log(d);
+
+            for (size_t i = j + 1; i < D; ++i){
+                double s = covariance_[i * D + j];
+                for (size_t k = 0; k < j; ++k)
+                    s -= chol_[i * D + k] * chol_[j * D + k];
+                chol_[i * D + j] = s / d;
+            }
+        }
+        update_norm();
+    }
+
+    void update_norm(){
+        log_norm_ = std::log(alpha_) - 0.5 * D * std::log(2 * M_PI) - 0.5 * log_det_;
+    }
+
+    value_type mean_;
+    matrix_type covariance_;
+    double alpha_;
+
+    matrix_type chol_{};
+    std::array<double, D> inv_diag_{};
+    double log_det_ = 0;
+    double log_norm_ = 0;
+};
+
+}
+
+#endif // MULTIVARIATE_GAUSSIAN_H